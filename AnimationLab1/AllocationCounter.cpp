@@ -0,0 +1,45 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+static THREAD_LOCAL long threadAllocations = 0;
+
+long AllocationCounter::Count()
+{
+	return threadAllocations;
+}
+
+//Replacements for the global allocation functions, these just count and forward to malloc/free
+void* operator new(size_t size)
+{
+	threadAllocations++;
+
+	void* p = malloc(size > 0 ? size : 1);
+
+	if(!p)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+	free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+	free(p);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+//Counts calls to the global operator new made by the calling thread.
+//Take the count before and after a block of code to see how many heap allocations it made.
+class AllocationCounter
+{
+	public:
+		static long Count();
+};
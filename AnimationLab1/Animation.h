@@ -2,65 +2,272 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <glm\gtx\quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
 
 #include <vector>
+#include <string>
+#include <algorithm>
 
-#include "Helper.h"
+#include "AnimationMath.h"
 #include "Common.h"
+#include "AnimationCompression.h"
 
-struct PosKeyFrame
+//Remembers where the last sample landed in a keyframe channel, so the next sample can
+//carry on from there instead of searching from the first key
+struct KeyframeCursor
 {
-	glm::vec3 position;
-	double time;
+	int key; //Index of the earlier of the two keyframes used last time
+	double time; //Local clock of the last sample
+
+	KeyframeCursor() : key(0), time(0.0) {}
 };
 
-struct RotKeyFrame
+#define MAX_CURSOR_STEPS 4 //Further than this and a binary search is cheaper
+
+//Finds the pair of keyframes around time and returns the index of the earlier one, the later one is always index + 1.
+//Keys are walked forward from the cursor while the clock moves forward, a loop wrap or seek falls back to a binary search.
+//Needs at least two keyframes.
+template<typename T>
+int FindKeyframe(const T* times, int count, double time, KeyframeCursor& cursor)
 {
-	glm::quat rotation;
-	double time;
-};
+	int lastKey = count - 2;
+	int key = cursor.key;
+
+	bool found = false;
+
+	if(time >= cursor.time && key <= lastKey)
+	{
+		for(int step = 0; step <= MAX_CURSOR_STEPS; step++)
+		{
+			if(key == lastKey || times[key + 1] >= time)
+			{
+				found = true;
+				break;
+			}
+
+			key++;
+		}
+	}
+
+	if(!found)
+	{
+		//The first key after the start whose time is >= time is the later of the pair
+		const T* next = std::lower_bound(times + 1, times + count, (T)time);
+		key = int(next - times) - 1;
+
+		if(key > lastKey) //time is past the last key
+			key = lastKey;
+	}
 
-struct BoneAnimationData
+	cursor.key = key;
+	cursor.time = time;
+
+	return key;
+}
+
+//Cheaper than slerp and close to it between nearby keys, takes the short way round like glm::slerp
+inline glm::quat Nlerp(const glm::quat& a, const glm::quat& b, float t)
+{
+	float sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+
+	return glm::normalize(glm::quat(
+		a.w + (b.w * sign - a.w) * t,
+		a.x + (b.x * sign - a.x) * t,
+		a.y + (b.y * sign - a.y) * t,
+		a.z + (b.z * sign - a.z) * t));
+}
+
+//Where one bone's keyframes live in the animation's key streams
+struct AnimationTrack
 {
 	int boneID;
-	std::vector<PosKeyFrame*> posKeyframes;
-	std::vector<RotKeyFrame*> rotKeyframes;
+
+	int posOffset;
+	int posCount;
+
+	int rotOffset;
+	int rotCount;
+
+	//Bounds the packed translations are quantized within
+	glm::vec3 posMin;
+	glm::vec3 posExtent;
+};
+
+//Override animations are averaged together by weight, additive ones are then layered on top of the result
+enum BlendMode { BlendOverride = 0, BlendAdditive };
+
+//The keyframes of one animation file. Never changes once loaded, so every skeleton playing it shares the one copy
+//through the ClipLibrary. Tracks name their bones by index into trackNames, Animation maps them onto a rig.
+struct AnimationClip
+{
+	std::string name;
+	double duration;
+
+	std::vector<std::string> trackNames;
+
+	//Keyframes for every track, stored back to back with times and values in separate streams
+	std::vector<AnimationTrack> tracks;
+
+	std::vector<double> posTimes;
+	std::vector<glm::vec3> posValues;
+
+	std::vector<double> rotTimes;
+	std::vector<glm::quat> rotValues;
+
+	//Packed key streams, these replace the ones above once the clip is compressed
+	bool compressed;
+
+	std::vector<float> packedPosTimes;
+	std::vector<unsigned short> packedPosValues; //3 per key
+
+	std::vector<float> packedRotTimes;
+	std::vector<unsigned short> packedRotValues; //3 per key
+
+	AnimationClip(const std::string& name, double duration) : name(name), duration(duration), compressed(false) {}
+
+	int GetNumKeys() const
+	{ 
+		if(compressed)
+			return packedPosTimes.size() + packedRotTimes.size();
+
+		return posTimes.size() + rotTimes.size(); 
+	}
+
+	glm::vec3 SamplePosition(int trackIdx, double time, KeyframeCursor& cursor) const
+	{
+		const AnimationTrack& track = tracks[trackIdx];
+
+		if(track.posCount == 0)
+			return glm::vec3();
+
+		if(compressed)
+			return SamplePackedPosition(trackIdx, time, cursor);
+
+		if(track.posCount == 1)
+			return posValues[track.posOffset];
+
+		const double* times = &posTimes[track.posOffset];
+		const glm::vec3* values = &posValues[track.posOffset];
+
+		int key = FindKeyframe(times, track.posCount, time, cursor);
+		float t = (time - times[key]) / (times[key + 1] - times[key]);
+
+		return lerp(values[key], values[key + 1], t);
+	}
+
+	glm::quat SampleRotation(int trackIdx, double time, KeyframeCursor& cursor, bool cheapInterpolation = false) const
+	{
+		const AnimationTrack& track = tracks[trackIdx];
+
+		if(track.rotCount == 0)
+			return glm::quat();
+
+		if(compressed)
+			return SamplePackedRotation(trackIdx, time, cursor, cheapInterpolation);
+
+		if(track.rotCount == 1)
+			return rotValues[track.rotOffset];
+
+		const double* times = &rotTimes[track.rotOffset];
+		const glm::quat* values = &rotValues[track.rotOffset];
+
+		int key = FindKeyframe(times, track.rotCount, time, cursor);
+		float t = (time - times[key]) / (times[key + 1] - times[key]);
+
+		if(cheapInterpolation)
+			return Nlerp(values[key], values[key + 1], t);
+
+		return glm::slerp(values[key], values[key + 1], t);
+	}
+
+	glm::vec3 SamplePackedPosition(int trackIdx, double time, KeyframeCursor& cursor) const
+	{
+		const AnimationTrack& track = tracks[trackIdx];
+		const unsigned short* values = &packedPosValues[track.posOffset * 3];
+
+		if(track.posCount == 1)
+			return UnpackPosition(values, track.posMin, track.posExtent);
+
+		const float* times = &packedPosTimes[track.posOffset];
+
+		int key = FindKeyframe(times, track.posCount, time, cursor);
+		float t = (time - times[key]) / (times[key + 1] - times[key]);
+
+		return lerp(UnpackPosition(values + key * 3, track.posMin, track.posExtent), 
+			UnpackPosition(values + (key + 1) * 3, track.posMin, track.posExtent), t);
+	}
+
+	glm::quat SamplePackedRotation(int trackIdx, double time, KeyframeCursor& cursor, bool cheapInterpolation = false) const
+	{
+		const AnimationTrack& track = tracks[trackIdx];
+		const unsigned short* values = &packedRotValues[track.rotOffset * 3];
+
+		if(track.rotCount == 1)
+			return UnpackQuaternion(values);
+
+		const float* times = &packedRotTimes[track.rotOffset];
+
+		int key = FindKeyframe(times, track.rotCount, time, cursor);
+		float t = (time - times[key]) / (times[key + 1] - times[key]);
+
+		if(cheapInterpolation)
+			return Nlerp(UnpackQuaternion(values + key * 3), UnpackQuaternion(values + (key + 1) * 3), t);
+
+		return glm::slerp(UnpackQuaternion(values + key * 3), UnpackQuaternion(values + (key + 1) * 3), t);
+	}
 };
 
+//One skeleton's playback of a clip: the clock, weight and cursors. The clip and the track to bone mapping are shared.
 struct Animation {
 
 	int animationID;
-	std::string name;
+
+	const AnimationClip* clip;
+	const std::vector<int>* trackBoneIDs; //The bone on this skeleton's rig each track drives, -1 if it has no such bone
 
 	double localClock;
 	double duration;
 
-	std::vector<BoneAnimationData*> animationData;
+	//One cursor per track and channel
+	std::vector<KeyframeCursor> posCursors;
+	std::vector<KeyframeCursor> rotCursors;
 
 	float weight;
 	bool frozen;
 
 	bool loop;
 
+	BlendMode blendMode;
+	int maskID; //Index of one of the skeleton's bone masks, -1 for every bone
+
+	//What an additive animation's poses are taken relative to, one per track
+	std::vector<glm::vec3> referencePositions;
+	std::vector<glm::quat> referenceRotations;
+
 	//std::vector<Bone*> effectedBones;
-	
-	Animation(std::string name, int id, double duration)
+
+	Animation(const AnimationClip* clip, const std::vector<int>* trackBoneIDs, int id)
 	{
-		this->name = name;
+		this->clip = clip;
+		this->trackBoneIDs = trackBoneIDs;
 		animationID = id;
-		this->duration = duration;
+		duration = clip->duration;
 
 		localClock = 0.0;
 		weight = 0.0; //How much is it contributing to the pose?
 		frozen = true; //Is the clock running?
+
+		blendMode = BlendOverride;
+		maskID = -1;
+
+		ResetCursors();
 	}
 
 	void Start(float weight, bool loop)
 	{
 		localClock = 0.0;
-		this->weight = weight; 
-		frozen = false; 
+		this->weight = weight;
+		frozen = false;
 		this->loop = loop;
 	}
 
@@ -68,6 +275,41 @@ struct Animation {
 	{
 		localClock = 0.0;
 		weight = 0.0;
-		frozen = true; 
+		frozen = true;
+	}
+
+	void ResetCursors()
+	{
+		posCursors.assign(clip->tracks.size(), KeyframeCursor());
+		rotCursors.assign(clip->tracks.size(), KeyframeCursor());
 	}
-};
\ No newline at end of file
+
+	//Plays the animation as offsets from its first frame, e.g. a punch layered over a run
+	void MakeAdditive()
+	{
+		double savedClock = localClock;
+		localClock = 0.0;
+
+		referencePositions.resize(GetNumTracks());
+		referenceRotations.resize(GetNumTracks());
+
+		for(int trackIdx = 0; trackIdx < GetNumTracks(); trackIdx++)
+		{
+			referencePositions[trackIdx] = SamplePosition(trackIdx);
+			referenceRotations[trackIdx] = SampleRotation(trackIdx);
+		}
+
+		localClock = savedClock;
+		ResetCursors();
+
+		blendMode = BlendAdditive;
+	}
+
+	const std::string& GetName() const { return clip->name; }
+	int GetNumTracks() const { return clip->tracks.size(); }
+	int GetBoneID(int trackIdx) const { return (*trackBoneIDs)[trackIdx]; }
+	int GetNumKeys() const { return clip->GetNumKeys(); }
+
+	glm::vec3 SamplePosition(int trackIdx) { return clip->SamplePosition(trackIdx, localClock, posCursors[trackIdx]); }
+	glm::quat SampleRotation(int trackIdx, bool cheapInterpolation = false) { return clip->SampleRotation(trackIdx, localClock, rotCursors[trackIdx], cheapInterpolation); }
+};
@@ -0,0 +1,189 @@
+#include "AnimationCompression.h"
+#include "Animation.h"
+
+#include <vector>
+
+static glm::vec3 Interpolate(const glm::vec3& a, const glm::vec3& b, float t) { return lerp(a, b, t); }
+static glm::quat Interpolate(const glm::quat& a, const glm::quat& b, float t) { return glm::slerp(a, b, t); }
+
+static float KeyError(const glm::vec3& a, const glm::vec3& b) { return glm::distance(a, b); }
+static float KeyError(const glm::quat& a, const glm::quat& b) { return RotationError(a, b); }
+
+//Slerp takes the short way round, which becomes a coin toss near half a turn once the keys are quantized
+static bool CanSpan(const glm::vec3&, const glm::vec3&) { return true; }
+static bool CanSpan(const glm::quat& a, const glm::quat& b) { return RotationError(a, b) < glm::half_pi<float>(); }
+
+float RotationError(const glm::quat& a, const glm::quat& b)
+{
+	glm::quat difference = glm::inverse(a) * b;
+
+	//atan2 of the vector part stays accurate for the tiny angles we care about, acos of the dot product doesn't
+	return 2.0f * atan2(glm::length(glm::vec3(difference.x, difference.y, difference.z)), fabs(difference.w));
+}
+
+//Greedy key reduction: keep stretching a segment from the last kept key until one of the keys
+//it skips can't be rebuilt within tolerance, then keep the key before that and start again from it
+template<typename T>
+static std::vector<int> ReduceKeys(const double* times, const T* values, int count, float tolerance)
+{
+	std::vector<int> kept;
+
+	if(count == 0)
+		return kept;
+
+	kept.push_back(0);
+	int anchor = 0;
+
+	for(int next = 2; next < count; next++)
+	{
+		double span = times[next] - times[anchor];
+
+		if(!CanSpan(values[anchor], values[next]))
+		{
+			anchor = next - 1;
+			kept.push_back(anchor);
+			continue;
+		}
+
+		for(int skipped = anchor + 1; skipped < next; skipped++)
+		{
+			float t = span > 0.0 ? float((times[skipped] - times[anchor]) / span) : 0.0f;
+
+			if(KeyError(Interpolate(values[anchor], values[next], t), values[skipped]) > tolerance)
+			{
+				anchor = next - 1;
+				kept.push_back(anchor);
+				break;
+			}
+		}
+	}
+
+	if(count > 1)
+		kept.push_back(count - 1);
+
+	return kept;
+}
+
+template<typename T>
+static T SampleKeys(const double* times, const T* values, int count, double time)
+{
+	if(count == 1)
+		return values[0];
+
+	KeyframeCursor cursor;
+	cursor.time = time + 1.0; //Force a search
+
+	int key = FindKeyframe(times, count, time, cursor);
+	float t = (time - times[key]) / (times[key + 1] - times[key]);
+
+	return Interpolate(values[key], values[key + 1], t);
+}
+
+CompressionReport CompressAnimation(AnimationClip* clip, float positionTolerance, float rotationTolerance)
+{
+	CompressionReport report;
+
+	if(clip->compressed)
+		return report;
+
+	report.rawKeys = clip->GetNumKeys();
+	report.rawBytes = clip->posTimes.size() * (sizeof(double) + sizeof(glm::vec3))
+		+ clip->rotTimes.size() * (sizeof(double) + sizeof(glm::quat));
+
+	std::vector<AnimationTrack> rawTracks = clip->tracks;
+
+	for(int trackIdx = 0; trackIdx < clip->tracks.size(); trackIdx++)
+	{
+		const AnimationTrack& rawTrack = rawTracks[trackIdx];
+		AnimationTrack& track = clip->tracks[trackIdx];
+
+		//Translations
+		const double* posTimes = rawTrack.posCount > 0 ? &clip->posTimes[rawTrack.posOffset] : 0;
+		const glm::vec3* posValues = rawTrack.posCount > 0 ? &clip->posValues[rawTrack.posOffset] : 0;
+
+		std::vector<int> keptPos = ReduceKeys(posTimes, posValues, rawTrack.posCount, positionTolerance);
+
+		glm::vec3 posMax;
+		track.posMin = glm::vec3();
+
+		for(int i = 0; i < keptPos.size(); i++)
+		{
+			const glm::vec3& position = posValues[keptPos[i]];
+
+			track.posMin = i == 0 ? position : glm::min(track.posMin, position);
+			posMax = i == 0 ? position : glm::max(posMax, position);
+		}
+
+		track.posExtent = posMax - track.posMin;
+		track.posOffset = clip->packedPosTimes.size();
+		track.posCount = keptPos.size();
+
+		for(int i = 0; i < keptPos.size(); i++)
+		{
+			unsigned short packed[3];
+			PackPosition(posValues[keptPos[i]], track.posMin, track.posExtent, packed);
+
+			clip->packedPosTimes.push_back(posTimes[keptPos[i]]);
+			clip->packedPosValues.insert(clip->packedPosValues.end(), packed, packed + 3);
+		}
+
+		//Rotations
+		const double* rotTimes = rawTrack.rotCount > 0 ? &clip->rotTimes[rawTrack.rotOffset] : 0;
+		const glm::quat* rotValues = rawTrack.rotCount > 0 ? &clip->rotValues[rawTrack.rotOffset] : 0;
+
+		std::vector<int> keptRot = ReduceKeys(rotTimes, rotValues, rawTrack.rotCount, rotationTolerance);
+
+		track.rotOffset = clip->packedRotTimes.size();
+		track.rotCount = keptRot.size();
+
+		for(int i = 0; i < keptRot.size(); i++)
+		{
+			unsigned short packed[3];
+			PackQuaternion(rotValues[keptRot[i]], packed);
+
+			clip->packedRotTimes.push_back(rotTimes[keptRot[i]]);
+			clip->packedRotValues.insert(clip->packedRotValues.end(), packed, packed + 3);
+		}
+	}
+
+	clip->compressed = true;
+
+	report.keptKeys = clip->GetNumKeys();
+	report.compressedBytes = clip->packedPosTimes.size() * sizeof(float) + clip->packedPosValues.size() * sizeof(unsigned short)
+		+ clip->packedRotTimes.size() * sizeof(float) + clip->packedRotValues.size() * sizeof(unsigned short);
+
+	//Measure how far the packed clip strays from the raw one, at every raw key and halfway between them
+	for(int trackIdx = 0; trackIdx < rawTracks.size(); trackIdx++)
+	{
+		const AnimationTrack& rawTrack = rawTracks[trackIdx];
+		KeyframeCursor posCursor, rotCursor;
+
+		for(int i = 0; i < rawTrack.posCount * 2 - 1; i++)
+		{
+			const double* times = &clip->posTimes[rawTrack.posOffset];
+			double time = i % 2 == 0 ? times[i / 2] : (times[i / 2] + times[i / 2 + 1]) * 0.5;
+
+			glm::vec3 raw = SampleKeys(times, &clip->posValues[rawTrack.posOffset], rawTrack.posCount, time);
+
+			report.maxPositionError = glm::max(report.maxPositionError, KeyError(raw, clip->SamplePosition(trackIdx, time, posCursor)));
+		}
+
+		for(int i = 0; i < rawTrack.rotCount * 2 - 1; i++)
+		{
+			const double* times = &clip->rotTimes[rawTrack.rotOffset];
+			double time = i % 2 == 0 ? times[i / 2] : (times[i / 2] + times[i / 2 + 1]) * 0.5;
+
+			glm::quat raw = SampleKeys(times, &clip->rotValues[rawTrack.rotOffset], rawTrack.rotCount, time);
+
+			report.maxRotationError = glm::max(report.maxRotationError, KeyError(raw, clip->SampleRotation(trackIdx, time, rotCursor)));
+		}
+	}
+
+	//Release the raw streams
+	std::vector<double>().swap(clip->posTimes);
+	std::vector<glm::vec3>().swap(clip->posValues);
+	std::vector<double>().swap(clip->rotTimes);
+	std::vector<glm::quat>().swap(clip->rotValues);
+
+	return report;
+}
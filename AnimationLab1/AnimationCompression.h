@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <math.h>
+
+struct AnimationClip;
+
+#define QUANTIZED_RANGE 65535.0f //16 bits per translation component
+#define QUANTIZED_QUAT_RANGE 32767.0f //15 bits per quaternion component, the rest holds the dropped component's index
+#define SQRT2 1.41421356f
+
+//What compressing a clip did to it
+struct CompressionReport
+{
+	int rawBytes;
+	int compressedBytes;
+
+	int rawKeys;
+	int keptKeys;
+
+	float maxPositionError; //Distance, in model units
+	float maxRotationError; //Angle, in radians
+
+	CompressionReport() : rawBytes(0), compressedBytes(0), rawKeys(0), keptKeys(0), maxPositionError(0.0f), maxRotationError(0.0f) {}
+};
+
+//Drops keys that can be rebuilt from their neighbours within tolerance, then quantizes what's left:
+//translations to 16 bits per component inside each track's bounds, rotations with the smallest three method.
+//The raw key streams are released and the clip samples the packed ones from then on.
+CompressionReport CompressAnimation(AnimationClip* clip, float positionTolerance, float rotationTolerance);
+
+//Angle between two orientations
+float RotationError(const glm::quat& a, const glm::quat& b);
+
+inline void PackPosition(const glm::vec3& position, const glm::vec3& min, const glm::vec3& extent, unsigned short* out)
+{
+	for(int i = 0; i < 3; i++)
+	{
+		float t = extent[i] > 0.0f ? (position[i] - min[i]) / extent[i] : 0.0f;
+		out[i] = (unsigned short)(glm::clamp(t, 0.0f, 1.0f) * QUANTIZED_RANGE + 0.5f);
+	}
+}
+
+inline glm::vec3 UnpackPosition(const unsigned short* in, const glm::vec3& min, const glm::vec3& extent)
+{
+	return min + glm::vec3(in[0], in[1], in[2]) * (extent / QUANTIZED_RANGE);
+}
+
+//Smallest three: the largest component is dropped and rebuilt from the other three, which
+//then all lie in [-1/sqrt2, 1/sqrt2]. Its index goes in the top bits of the first two values.
+inline void PackQuaternion(const glm::quat& q, unsigned short* out)
+{
+	float components[4] = { q.x, q.y, q.z, q.w };
+
+	int largest = 0;
+	for(int i = 1; i < 4; i++)
+	{
+		if(fabs(components[i]) > fabs(components[largest]))
+			largest = i;
+	}
+
+	float sign = components[largest] < 0.0f ? -1.0f : 1.0f; //q and -q are the same rotation, keep the dropped one positive
+
+	int packed = 0;
+	for(int i = 0; i < 4; i++)
+	{
+		if(i == largest)
+			continue;
+
+		float t = (components[i] * sign * SQRT2 + 1.0f) * 0.5f;
+		out[packed++] = (unsigned short)(glm::clamp(t, 0.0f, 1.0f) * QUANTIZED_QUAT_RANGE + 0.5f);
+	}
+
+	out[0] |= (largest & 1) << 15;
+	out[1] |= (largest >> 1) << 15;
+}
+
+inline glm::quat UnpackQuaternion(const unsigned short* in)
+{
+	int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+	float components[4];
+	float sumOfSquares = 0.0f;
+
+	int packed = 0;
+	for(int i = 0; i < 4; i++)
+	{
+		if(i == largest)
+			continue;
+
+		float t = (in[packed++] & 0x7FFF) / QUANTIZED_QUAT_RANGE;
+		components[i] = (t * 2.0f - 1.0f) / SQRT2;
+		sumOfSquares += components[i] * components[i];
+	}
+
+	components[largest] = sqrt(glm::max(0.0f, 1.0f - sumOfSquares));
+
+	return glm::quat(components[3], components[0], components[1], components[2]); //glm takes w first
+}
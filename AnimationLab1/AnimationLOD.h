@@ -0,0 +1,32 @@
+#pragma once
+
+#define NUM_ANIMATION_LODS 3
+
+//How much work a skeleton gets at one distance from the camera
+struct AnimationLODSettings
+{
+	float maxDistance; //This level is used up to here, the last level covers everything past the one before it
+	int updateInterval; //Animate every this many frames, with the time in between saved up
+	bool skipDetailBones; //Leave out the bones the rig marked with Skeleton::SetDetailBones
+	bool cheapInterpolation; //Normalised lerp instead of slerp for rotations
+};
+
+struct AnimationLOD
+{
+	static bool Enabled;
+	static AnimationLODSettings Levels[NUM_ANIMATION_LODS];
+
+	static int SelectLevel(float distance)
+	{
+		if(!Enabled)
+			return 0;
+
+		for(int level = 0; level < NUM_ANIMATION_LODS - 1; level++)
+		{
+			if(distance <= Levels[level].maxDistance)
+				return level;
+		}
+
+		return NUM_ANIMATION_LODS - 1;
+	}
+};
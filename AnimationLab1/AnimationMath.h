@@ -0,0 +1,23 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#ifndef ANIMATION_NO_ASSIMP
+#include <assimp/scene.h>
+#endif
+
+//Maths shared by the animation runtime, kept free of anything windowing or GL so the runtime builds anywhere
+
+glm::quat formQuaternion(double x, double y, double z, double angle);
+glm::vec3 lerp(glm::vec3 v0, glm::vec3 v1, float t);
+float lerp(float w0, float w1, float t);
+glm::vec3 cubicLerp(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, glm::vec3 v3, float t);
+//betterLerp(v0,v1,t) { return (1-t)*v0 + t*v1; }
+void decomposeTRS(const glm::mat4& m, glm::vec3& translation,
+        glm::mat4& rotation, glm::vec3& scaling);
+glm::vec3 decomposeT(glm::mat4 m);
+
+#ifndef ANIMATION_NO_ASSIMP
+glm::mat4 convertAssimpMatrix (aiMatrix4x4 m);
+#endif
@@ -0,0 +1,787 @@
+#include "AssetCache.h"
+#include "SkeletonDefinition.h"
+#include "MappedFile.h"
+#include "Timer.h"
+#include "AnimationMath.h"
+#include "Profiler.h"
+
+#ifndef ANIMATION_NO_ASSIMP
+#include <assimp/cimport.h> // C importer
+#include <assimp/scene.h> // collects data
+#include <assimp/postprocess.h> // various extra operations
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+#pragma region READING AND WRITING
+template<typename T>
+static void Write(FILE* file, const T& value)
+{
+	fwrite(&value, sizeof(T), 1, file);
+}
+
+template<typename T>
+static void WriteArray(FILE* file, const std::vector<T>& values)
+{
+	unsigned int count = values.size();
+	Write(file, count);
+
+	if(count > 0)
+		fwrite(&values[0], sizeof(T), count, file);
+}
+
+static void WriteString(FILE* file, const std::string& value)
+{
+	unsigned int length = value.size();
+	Write(file, length);
+	fwrite(value.data(), 1, length, file);
+}
+
+static void WriteStrings(FILE* file, const std::vector<std::string>& values)
+{
+	unsigned int count = values.size();
+	Write(file, count);
+
+	for(int i = 0; i < values.size(); i++)
+		WriteString(file, values[i]);
+}
+
+//Walks a baked file in memory, once a read runs off the end every read after it fails too
+struct BakedReader
+{
+	const char* cursor;
+	const char* end;
+	bool ok;
+
+	BakedReader() : cursor(0), end(0), ok(false) {}
+	BakedReader(const char* data, size_t size) : cursor(data), end(data + size), ok(true) {}
+
+	bool Take(void* out, size_t bytes)
+	{
+		if(!ok || bytes > size_t(end - cursor))
+		{
+			ok = false;
+			return false;
+		}
+
+		if(bytes > 0)
+			memcpy(out, cursor, bytes);
+
+		cursor += bytes;
+		return true;
+	}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		return Take(&value, sizeof(T));
+	}
+
+	template<typename T>
+	bool ReadArray(std::vector<T>& values)
+	{
+		unsigned int count = 0;
+
+		if(!Read(count) || count > size_t(end - cursor) / sizeof(T))
+		{
+			ok = false;
+			return false;
+		}
+
+		values.resize(count);
+		return count == 0 || Take(&values[0], count * sizeof(T));
+	}
+
+	bool ReadString(std::string& value)
+	{
+		unsigned int length = 0;
+
+		if(!Read(length) || length > size_t(end - cursor))
+		{
+			ok = false;
+			return false;
+		}
+
+		value.assign(cursor, length);
+		cursor += length;
+		return true;
+	}
+
+	bool ReadStrings(std::vector<std::string>& values)
+	{
+		unsigned int count = 0;
+
+		if(!Read(count) || count > size_t(end - cursor) / sizeof(unsigned int)) //Every string has at least its length
+		{
+			ok = false;
+			return false;
+		}
+
+		values.resize(count);
+		for(int i = 0; i < count; i++)
+			ReadString(values[i]);
+
+		return ok;
+	}
+};
+
+static bool GetSourceStamp(const char* fileName, long long& size, long long& time)
+{
+	struct stat info;
+
+	if(stat(fileName, &info) != 0)
+		return false;
+
+	size = info.st_size;
+	time = info.st_mtime;
+	return true;
+}
+
+//Maps the baked copy of a source file and checks it's one we can use, leaving the reader just past the header
+static bool OpenBaked(const char* sourceFileName, BakedAssetType type, MappedFile& file, BakedReader& reader, bool report)
+{
+	std::string bakedFileName = AssetCache::GetBakedFileName(sourceFileName);
+
+	if(!file.Open(bakedFileName.c_str())) //Never been baked
+		return false;
+
+	reader = BakedReader(file.GetData(), file.GetSize());
+
+	BakedHeader header;
+	if(!reader.Read(header) || header.magic != BAKED_MAGIC || header.version != BAKED_VERSION || header.type != type)
+	{
+		if(report)
+			printf("%s is not a version %i bake, loading %s instead\n", bakedFileName.c_str(), BAKED_VERSION, sourceFileName);
+
+		return false;
+	}
+
+	//If the source is gone the bake is all we have, so only a source that has changed makes it stale
+	long long size, time;
+	if(GetSourceStamp(sourceFileName, size, time) && (size != header.sourceSize || time != header.sourceTime))
+	{
+		if(report)
+			printf("%s is stale, loading %s instead\n", bakedFileName.c_str(), sourceFileName);
+
+		return false;
+	}
+
+	return true;
+}
+
+static FILE* CreateBaked(const char* sourceFileName, BakedAssetType type)
+{
+	BakedHeader header;
+	header.magic = BAKED_MAGIC;
+	header.version = BAKED_VERSION;
+	header.type = type;
+	header.reserved = 0;
+
+	if(!GetSourceStamp(sourceFileName, header.sourceSize, header.sourceTime))
+	{
+		fprintf(stderr, "ERROR: can't bake %s, the file is missing\n", sourceFileName);
+		return 0;
+	}
+
+	std::string bakedFileName = AssetCache::GetBakedFileName(sourceFileName);
+	FILE* file = fopen(bakedFileName.c_str(), "wb");
+
+	if(!file)
+	{
+		fprintf(stderr, "ERROR: can't write %s\n", bakedFileName.c_str());
+		return 0;
+	}
+
+	Write(file, header);
+	return file;
+}
+
+static bool CloseBaked(const char* sourceFileName, FILE* file)
+{
+	bool ok = ferror(file) == 0;
+	ok = fclose(file) == 0 && ok;
+
+	if(!ok) //Don't leave a half written bake lying around
+	{
+		std::string bakedFileName = AssetCache::GetBakedFileName(sourceFileName);
+		fprintf(stderr, "ERROR: failed writing %s\n", bakedFileName.c_str());
+		remove(bakedFileName.c_str());
+	}
+
+	return ok;
+}
+#pragma endregion
+
+bool AssetCache::IsBakeCurrent(const char* sourceFileName, BakedAssetType type)
+{
+	MappedFile file;
+	BakedReader reader;
+
+	return OpenBaked(sourceFileName, type, file, reader, false);
+}
+
+bool AssetCache::LoadClip(const char* fileName, ClipData& clip)
+{
+	PROFILE_SCOPE("AssetCache::LoadClip");
+
+	if(ReadBakedClip(fileName, clip))
+		return true;
+
+	return ImportClip(fileName, clip);
+}
+
+bool AssetCache::LoadMesh(const char* fileName, MeshData& mesh)
+{
+	PROFILE_SCOPE("AssetCache::LoadMesh");
+
+	if(ReadBakedMesh(fileName, mesh))
+		return true;
+
+	return ImportMesh(fileName, mesh);
+}
+
+#pragma region CLIPS
+bool AssetCache::ReadBakedClip(const char* sourceFileName, ClipData& clip)
+{
+	MappedFile file;
+	BakedReader reader;
+
+	if(!OpenBaked(sourceFileName, BakedClip, file, reader, true))
+		return false;
+
+	reader.Read(clip.duration);
+	reader.ReadStrings(clip.trackNames);
+	reader.ReadArray(clip.tracks);
+	reader.ReadArray(clip.posTimes);
+	reader.ReadArray(clip.posValues);
+	reader.ReadArray(clip.rotTimes);
+	reader.ReadArray(clip.rotValues);
+
+	if(!reader.ok || clip.trackNames.size() != clip.tracks.size())
+	{
+		fprintf(stderr, "ERROR: %s is truncated, loading %s instead\n", GetBakedFileName(sourceFileName).c_str(), sourceFileName);
+		clip = ClipData();
+		return false;
+	}
+
+	return true;
+}
+
+bool AssetCache::WriteBakedClip(const char* sourceFileName, const ClipData& clip)
+{
+	FILE* file = CreateBaked(sourceFileName, BakedClip);
+
+	if(!file)
+		return false;
+
+	Write(file, clip.duration);
+	WriteStrings(file, clip.trackNames);
+	WriteArray(file, clip.tracks);
+	WriteArray(file, clip.posTimes);
+	WriteArray(file, clip.posValues);
+	WriteArray(file, clip.rotTimes);
+	WriteArray(file, clip.rotValues);
+
+	return CloseBaked(sourceFileName, file);
+}
+
+bool AssetCache::ImportClip(const char* fileName, ClipData& clip)
+{
+	clip = ClipData();
+
+#ifdef ANIMATION_NO_ASSIMP
+	fprintf (stderr, "ERROR: %s isn't baked, and this build can't import source files\n", fileName);
+	return false;
+#else
+
+	const aiScene* scene = aiImportFile (fileName, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+	if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		fprintf (stderr, "ERROR: reading animation %s\n", fileName);
+		return false;
+	}
+
+	if(scene->HasAnimations())
+	{
+		aiAnimation* anim = scene->mAnimations[0];
+		clip.duration = anim->mDuration;
+
+		//Count the keys first so each stream is allocated once
+		int numPosKeys = 0;
+		int numRotKeys = 0;
+
+		for (int i = 0; i < (int)anim->mNumChannels; i++)
+		{
+			numPosKeys += anim->mChannels[i]->mNumPositionKeys;
+			numRotKeys += anim->mChannels[i]->mNumRotationKeys;
+		}
+
+		clip.trackNames.reserve(anim->mNumChannels);
+		clip.tracks.reserve(anim->mNumChannels);
+		clip.posTimes.reserve(numPosKeys);
+		clip.posValues.reserve(numPosKeys);
+		clip.rotTimes.reserve(numRotKeys);
+		clip.rotValues.reserve(numRotKeys);
+
+		// get the node channels
+		for (int i = 0; i < (int)anim->mNumChannels; i++)
+		{
+			aiNodeAnim* chan = anim->mChannels[i];
+
+			AnimationTrack track;
+			track.boneID = -1; //Filled in by the skeleton that loads the clip
+
+			// add position keys to node
+			track.posOffset = clip.posTimes.size();
+			track.posCount = chan->mNumPositionKeys;
+
+			for (int i = 0; i < chan->mNumPositionKeys; i++)
+			{
+				aiVectorKey key = chan->mPositionKeys[i];
+
+				clip.posTimes.push_back(key.mTime);
+				clip.posValues.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+			}
+
+			// add rotation keys to node
+			track.rotOffset = clip.rotTimes.size();
+			track.rotCount = chan->mNumRotationKeys;
+
+			for (int i = 0; i < chan->mNumRotationKeys; i++)
+			{
+				aiQuatKey key = chan->mRotationKeys[i];
+
+				glm::quat rotation;
+				rotation.x = key.mValue.x;
+				rotation.y = key.mValue.y;
+				rotation.z = key.mValue.z;
+				rotation.w = key.mValue.w;
+
+				clip.rotTimes.push_back(key.mTime);
+				clip.rotValues.push_back(rotation);
+			}
+
+			track.posMin = glm::vec3();
+			track.posExtent = glm::vec3();
+
+			clip.trackNames.push_back(chan->mNodeName.C_Str());
+			clip.tracks.push_back(track);
+		}
+	}
+
+	aiReleaseImport (scene);
+	return true;
+#endif
+}
+#pragma endregion
+
+#pragma region MESHES
+bool AssetCache::ReadBakedMesh(const char* sourceFileName, MeshData& mesh)
+{
+	MappedFile file;
+	BakedReader reader;
+
+	if(!OpenBaked(sourceFileName, BakedMesh, file, reader, true))
+		return false;
+
+	reader.Read(mesh.globalInverseTransform);
+	reader.ReadArray(mesh.positions);
+	reader.ReadArray(mesh.normals);
+	reader.ReadArray(mesh.texcoords);
+	reader.ReadArray(mesh.indices);
+
+	unsigned int numSubMeshes = 0;
+	reader.Read(numSubMeshes);
+
+	if(reader.ok && numSubMeshes <= file.GetSize()) //Don't trust the count until it's at least plausible
+	{
+		mesh.subMeshes.resize(numSubMeshes);
+
+		for(int i = 0; i < numSubMeshes && reader.ok; i++)
+		{
+			reader.Read(mesh.subMeshes[i].numIndices);
+			reader.Read(mesh.subMeshes[i].baseVertex);
+			reader.Read(mesh.subMeshes[i].baseIndex);
+			reader.ReadStrings(mesh.subMeshes[i].diffuseTextures);
+		}
+	}
+
+	reader.ReadString(mesh.rootName);
+
+	unsigned int numBones = 0;
+	reader.Read(numBones);
+
+	if(reader.ok && numBones <= file.GetSize())
+	{
+		mesh.bones.resize(numBones);
+
+		for(int i = 0; i < numBones && reader.ok; i++)
+		{
+			reader.ReadString(mesh.bones[i].name);
+			reader.Read(mesh.bones[i].parent);
+			reader.Read(mesh.bones[i].offset);
+			reader.Read(mesh.bones[i].transform);
+		}
+	}
+
+	reader.ReadArray(mesh.vertexWeights);
+
+	if(!reader.ok || numSubMeshes != mesh.subMeshes.size() || numBones != mesh.bones.size())
+	{
+		fprintf(stderr, "ERROR: %s is truncated, loading %s instead\n", GetBakedFileName(sourceFileName).c_str(), sourceFileName);
+		mesh = MeshData();
+		return false;
+	}
+
+	return true;
+}
+
+bool AssetCache::WriteBakedMesh(const char* sourceFileName, const MeshData& mesh)
+{
+	FILE* file = CreateBaked(sourceFileName, BakedMesh);
+
+	if(!file)
+		return false;
+
+	Write(file, mesh.globalInverseTransform);
+	WriteArray(file, mesh.positions);
+	WriteArray(file, mesh.normals);
+	WriteArray(file, mesh.texcoords);
+	WriteArray(file, mesh.indices);
+
+	unsigned int numSubMeshes = mesh.subMeshes.size();
+	Write(file, numSubMeshes);
+
+	for(int i = 0; i < mesh.subMeshes.size(); i++)
+	{
+		Write(file, mesh.subMeshes[i].numIndices);
+		Write(file, mesh.subMeshes[i].baseVertex);
+		Write(file, mesh.subMeshes[i].baseIndex);
+		WriteStrings(file, mesh.subMeshes[i].diffuseTextures);
+	}
+
+	WriteString(file, mesh.rootName);
+
+	unsigned int numBones = mesh.bones.size();
+	Write(file, numBones);
+
+	for(int i = 0; i < mesh.bones.size(); i++)
+	{
+		WriteString(file, mesh.bones[i].name);
+		Write(file, mesh.bones[i].parent);
+		Write(file, mesh.bones[i].offset);
+		Write(file, mesh.bones[i].transform);
+	}
+
+	WriteArray(file, mesh.vertexWeights);
+
+	return CloseBaked(sourceFileName, file);
+}
+
+bool AssetCache::ImportMesh(const char* fileName, MeshData& mesh, bool verbose)
+{
+	mesh = MeshData();
+
+#ifdef ANIMATION_NO_ASSIMP
+	(void)verbose; //Only said anything while importing
+	fprintf (stderr, "ERROR: %s isn't baked, and this build can't import source files\n", fileName);
+	return false;
+#else
+
+	const aiScene* scene = aiImportFile (fileName, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+	if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		fprintf (stderr, "ERROR: reading mesh %s\n", fileName);
+		return false;
+	}
+
+	mesh.globalInverseTransform = convertAssimpMatrix(scene->mRootNode->mTransformation);
+
+	if(verbose)
+	{
+		printf("%i animations\n", scene->mNumAnimations);
+		printf("%i cameras\n", scene->mNumCameras);
+		printf("%i lights\n", scene->mNumLights);
+		printf("%i materials\n", scene->mNumMaterials);
+		printf("%i textures\n", scene->mNumTextures);
+		printf("%i meshes\n", scene->mNumMeshes);
+	}
+
+	bool modelHasBones = false;
+
+	int vertexCount = 0;
+	int indexCount = 0;
+
+	for(int meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++)
+	{
+		aiMesh* aimesh = scene->mMeshes[meshIdx];
+
+		if(verbose)
+		{
+			printf("LOADING MESH[%i]\n", meshIdx);
+			printf("    %i vertices\n", aimesh->mNumVertices);
+			printf("    %i UV components\n", aimesh->mNumUVComponents);
+			printf("    %i anim meshes\n", aimesh->mNumAnimMeshes);
+			printf("    %i bones\n", aimesh->mNumBones);
+			printf("    %i faces\n", aimesh->mNumFaces);
+			printf("	%i normals\n", aimesh->HasNormals());
+		}
+
+		SubMeshData subMesh;
+		subMesh.baseIndex = indexCount;
+		subMesh.baseVertex = vertexCount;
+		subMesh.numIndices = aimesh->mNumFaces * 3;
+
+		vertexCount += aimesh->mNumVertices;
+		indexCount += subMesh.numIndices;
+
+		for(int vertIdx = 0; vertIdx < aimesh->mNumVertices; vertIdx++)
+		{
+			if (aimesh->HasPositions ())
+				mesh.positions.push_back(glm::vec3(aimesh->mVertices[vertIdx].x, aimesh->mVertices[vertIdx].y, aimesh->mVertices[vertIdx].z));
+			if (aimesh->HasNormals ())
+				mesh.normals.push_back(glm::vec3(aimesh->mNormals[vertIdx].x, aimesh->mNormals[vertIdx].y, aimesh->mNormals[vertIdx].z));
+			if (aimesh->HasTextureCoords (0))
+				mesh.texcoords.push_back(glm::vec2(aimesh->mTextureCoords[0][vertIdx].x, aimesh->mTextureCoords[0][vertIdx].y));
+		}
+
+		if(aimesh->HasFaces())
+		{
+			for (int i = 0 ; i < aimesh->mNumFaces ; i++)
+			{
+				const aiFace& Face = aimesh->mFaces[i];
+				assert(Face.mNumIndices == 3);
+
+				mesh.indices.push_back(Face.mIndices[0]);
+				mesh.indices.push_back(Face.mIndices[1]);
+				mesh.indices.push_back(Face.mIndices[2]);
+			}
+		}
+
+		if(aimesh->HasBones())
+			modelHasBones = true;
+
+		if(aimesh->mMaterialIndex >=0)
+		{
+			aiMaterial* material = scene->mMaterials[aimesh->mMaterialIndex];
+
+			if(verbose)
+			{
+				std::stringstream ss;
+				ss << "\nLoading " << material->GetTextureCount(aiTextureType_DIFFUSE) << " aiTextureType_DIFFUSE";
+				ss << "\nLoading " << material->GetTextureCount(aiTextureType_SPECULAR) << " aiTextureType_SPECULAR";
+				ss << "\nLoading " << material->GetTextureCount(aiTextureType_NORMALS) << " aiTextureType_NORMALS";
+				ss << "\nLoading " << material->GetTextureCount(aiTextureType_OPACITY) << " aiTextureType_OPACITY";
+				ss << "\nLoading " << material->GetTextureCount(aiTextureType_DISPLACEMENT) << " aiTextureType_DISPLACEMENT";
+				std::cout << ss.str();
+			}
+
+			for(int i = 0; i < material->GetTextureCount(aiTextureType_DIFFUSE); i++)
+			{
+				aiString str;
+				material->GetTexture(aiTextureType_DIFFUSE, i, &str);
+
+				subMesh.diffuseTextures.push_back(str.C_Str());
+			}
+		}
+
+		mesh.subMeshes.push_back(subMesh);
+	}
+
+	if (modelHasBones)
+	{
+		//Bone IDs come from the order the hierarchy import meets the bones in, so run it and keep what it made
+		SkeletonDefinition definition;
+
+		if(verbose)
+			printf ("\nBoneHierarchy\n");
+
+		definition.ImportAssimpBoneHierarchy(scene, verbose);
+		definition.FlattenHierarchy();
+		definition.GetHierarchy(mesh.rootName, mesh.bones);
+
+		if(verbose)
+			printf("\n\nLoading Weights\n");
+
+		mesh.vertexWeights.resize(vertexCount); //Zeroed
+
+		for (int meshIndex = 0; meshIndex < scene->mNumMeshes; meshIndex++)
+		{
+			for(int boneIdx = 0; boneIdx < scene->mMeshes[meshIndex]->mNumBones; boneIdx++)
+			{
+				const aiBone* bone = scene->mMeshes[meshIndex]->mBones[boneIdx]; //For every bone in the model
+				unsigned int boneID = definition.GetBoneID(bone->mName.C_Str());
+
+				for (int j = 0; j < (int)bone->mNumWeights; j++) //loop through its weights
+				{
+					int vertID = mesh.subMeshes[meshIndex].baseVertex + bone->mWeights[j].mVertexId;
+					float weight = bone->mWeights[j].mWeight;
+
+					for(int k = 0; k < NUM_WEIGHTS_PER_VERTEX; k++)
+					{
+						if(mesh.vertexWeights[vertID].weights[k] == 0.0f) //First free slot
+						{
+							mesh.vertexWeights[vertID].boneIDs[k] = boneID;
+							mesh.vertexWeights[vertID].weights[k] = weight;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	aiReleaseImport (scene);
+	return true;
+#endif
+}
+#pragma endregion
+
+#pragma region BAKING
+static std::vector<std::string> ListFiles(const char* directory)
+{
+	std::vector<std::string> files;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE search = FindFirstFileA((std::string(directory) + "/*").c_str(), &found);
+
+	if(search == INVALID_HANDLE_VALUE)
+		return files;
+
+	do
+	{
+		if(!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			files.push_back(found.cFileName);
+	}
+	while(FindNextFileA(search, &found));
+
+	FindClose(search);
+#else
+	DIR* dir = opendir(directory);
+
+	if(!dir)
+		return files;
+
+	while(dirent* entry = readdir(dir))
+	{
+		if(entry->d_name[0] != '.')
+			files.push_back(entry->d_name);
+	}
+
+	closedir(dir);
+#endif
+
+	return files;
+}
+
+//extensions is a list like ".dae;.bvh", case is ignored as some of the assets are .DAE
+static bool HasExtension(const std::string& fileName, const char* extensions)
+{
+	size_t dot = fileName.find_last_of('.');
+
+	if(dot == std::string::npos)
+		return false;
+
+	std::string extension = fileName.substr(dot);
+	for(int i = 0; i < extension.size(); i++)
+		extension[i] = tolower(extension[i]);
+
+	return (std::string(extensions) + ";").find(extension + ";") != std::string::npos;
+}
+
+int AssetCache::BakeAll(bool force)
+{
+	printf("\n\nBAKING\n");
+
+	int failed = 0;
+	failed += BakeDirectory("Animations", ".dae;.bvh", BakedClip, force);
+	failed += BakeDirectory("Models", ".dae", BakedMesh, force);
+
+	printf("\n%i failed\n", failed);
+	return failed;
+}
+
+int AssetCache::BakeDirectory(const char* directory, const char* extensions, BakedAssetType type, bool force)
+{
+	std::vector<std::string> files = ListFiles(directory);
+	std::sort(files.begin(), files.end());
+
+	int failed = 0;
+
+	for(int i = 0; i < files.size(); i++)
+	{
+		if(!HasExtension(files[i], extensions))
+			continue;
+
+		std::string fileName = std::string(directory) + "/" + files[i];
+
+		if(!force && IsBakeCurrent(fileName.c_str(), type))
+		{
+			printf("%s is up to date\n", fileName.c_str());
+			continue;
+		}
+
+		Timer timer;
+		bool baked = false;
+
+		if(type == BakedClip)
+		{
+			ClipData clip;
+			baked = ImportClip(fileName.c_str(), clip) && WriteBakedClip(fileName.c_str(), clip);
+		}
+		else
+		{
+			MeshData mesh;
+			baked = ImportMesh(fileName.c_str(), mesh, false) && WriteBakedMesh(fileName.c_str(), mesh);
+		}
+
+		if(baked)
+		{
+			double importTime = timer.ElapsedMilliseconds();
+
+			//Load it back, both to check it and to show what the bake saves
+			timer.Reset();
+
+			bool readBack = false;
+			if(type == BakedClip)
+			{
+				ClipData clip;
+				readBack = ReadBakedClip(fileName.c_str(), clip);
+			}
+			else
+			{
+				MeshData mesh;
+				readBack = ReadBakedMesh(fileName.c_str(), mesh);
+			}
+
+			if(readBack)
+				printf("Baked %s (import and bake %.1f ms, baked load %.2f ms)\n", fileName.c_str(), importTime, timer.ElapsedMilliseconds());
+			else
+				baked = false;
+		}
+
+		if(!baked)
+		{
+			fprintf(stderr, "ERROR: failed to bake %s\n", fileName.c_str());
+			failed++;
+		}
+	}
+
+	return failed;
+}
+#pragma endregion
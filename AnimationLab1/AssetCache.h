@@ -0,0 +1,117 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <string>
+#include <vector>
+
+#include "Animation.h"
+
+//Baked assets sit next to their source file, e.g. Animations/walk.dae -> Animations/walk.dae.baked
+#define BAKED_EXTENSION ".baked"
+#define BAKED_MAGIC 0x4B41424C //"LBAK"
+#define BAKED_VERSION 2 //Bump whenever the layout of anything written below changes
+
+#define NUM_WEIGHTS_PER_VERTEX 4
+
+enum BakedAssetType { BakedClip = 1, BakedMesh };
+
+struct BakedHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int type;
+	unsigned int reserved;
+
+	//Size and modification time of the source file when it was baked, if either changes the bake is stale
+	long long sourceSize;
+	long long sourceTime;
+};
+
+//A clip's keyframes as they come out of the source file. Clips are baked without a skeleton,
+//so each track names its bone and the skeleton loading it fills in the IDs.
+struct ClipData
+{
+	double duration;
+
+	std::vector<std::string> trackNames;
+	std::vector<AnimationTrack> tracks;
+
+	std::vector<double> posTimes;
+	std::vector<glm::vec3> posValues;
+
+	std::vector<double> rotTimes;
+	std::vector<glm::quat> rotValues;
+
+	ClipData() : duration(0.0) {}
+};
+
+struct VertexWeight
+{
+	unsigned int boneIDs[NUM_WEIGHTS_PER_VERTEX];
+	float weights[NUM_WEIGHTS_PER_VERTEX];
+};
+
+struct BoneData
+{
+	std::string name;
+	int parent; //-1 for children of the skeleton's root
+
+	glm::mat4 offset;
+	glm::mat4 transform;
+};
+
+struct SubMeshData
+{
+	unsigned int numIndices;
+	unsigned int baseVertex;
+	unsigned int baseIndex;
+
+	std::vector<std::string> diffuseTextures;
+};
+
+//Everything Model needs to build its buffers and skeleton
+struct MeshData
+{
+	glm::mat4 globalInverseTransform;
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> texcoords;
+	std::vector<int> indices;
+
+	std::vector<SubMeshData> subMeshes;
+
+	//Only filled in for skinned meshes, bones are in ID order which puts parents before children
+	std::string rootName;
+	std::vector<BoneData> bones;
+	std::vector<VertexWeight> vertexWeights;
+};
+
+//Loads assets from their baked copies when those are up to date, and from the source files through assimp otherwise.
+//Run with -bake on the command line to (re)bake everything in Animations/ and Models/.
+class AssetCache
+{
+	public:
+
+		static std::string GetBakedFileName(const char* sourceFileName) { return std::string(sourceFileName) + BAKED_EXTENSION; }
+		static bool IsBakeCurrent(const char* sourceFileName, BakedAssetType type);
+
+		//Baked copy first, source file if that is missing or stale
+		static bool LoadClip(const char* fileName, ClipData& clip);
+		static bool LoadMesh(const char* fileName, MeshData& mesh);
+
+		static bool ReadBakedClip(const char* sourceFileName, ClipData& clip);
+		static bool ReadBakedMesh(const char* sourceFileName, MeshData& mesh);
+
+		static bool ImportClip(const char* fileName, ClipData& clip);
+		static bool ImportMesh(const char* fileName, MeshData& mesh, bool verbose = true);
+
+		static bool WriteBakedClip(const char* sourceFileName, const ClipData& clip);
+		static bool WriteBakedMesh(const char* sourceFileName, const MeshData& mesh);
+
+		//Bakes every source file in Animations/ and Models/ whose bake is missing or stale, returns how many failed
+		static int BakeAll(bool force = false);
+		static int BakeDirectory(const char* directory, const char* extensions, BakedAssetType type, bool force);
+};
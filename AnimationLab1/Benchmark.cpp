@@ -0,0 +1,918 @@
+#include "Benchmark.h"
+#include "Skeleton.h"
+#include "Timer.h"
+#include "JobSystem.h"
+#include "SkinningKernel.h"
+#include "CpuSkinning.h"
+#include "RenderQueue.h"
+#include "Culling.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#include <algorithm>
+#include <string>
+
+#pragma region LEGACY KEYFRAME LAYOUT
+//The layout clips used before the key streams, kept here to compare against
+struct LegacyPosKeyFrame
+{
+	glm::vec3 position;
+	double time;
+};
+
+struct LegacyRotKeyFrame
+{
+	glm::quat rotation;
+	double time;
+};
+
+struct LegacyBoneAnimationData
+{
+	std::vector<LegacyPosKeyFrame*> posKeyframes;
+	std::vector<LegacyRotKeyFrame*> rotKeyframes;
+
+	KeyframeCursor posCursor;
+	KeyframeCursor rotCursor;
+};
+
+//Same search as FindKeyframe, capped walk and binary search fallback included, so only the layout differs
+template<typename KeyFrame>
+int FindLegacyKeyframe(const std::vector<KeyFrame*>& keyframes, double time, KeyframeCursor& cursor)
+{
+	int count = keyframes.size();
+	int lastKey = count - 2;
+	int key = cursor.key;
+
+	bool found = false;
+
+	if(time >= cursor.time && key <= lastKey)
+	{
+		for(int step = 0; step <= MAX_CURSOR_STEPS; step++)
+		{
+			if(key == lastKey || keyframes[key + 1]->time >= time)
+			{
+				found = true;
+				break;
+			}
+
+			key++;
+		}
+	}
+
+	if(!found)
+	{
+		int low = 1;
+		int high = count;
+
+		while(low < high)
+		{
+			int middle = (low + high) / 2;
+
+			if(keyframes[middle]->time < time)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		key = low - 1;
+
+		if(key > lastKey)
+			key = lastKey;
+	}
+
+	cursor.key = key;
+	cursor.time = time;
+
+	return key;
+}
+
+static glm::vec3 SampleLegacyPosition(LegacyBoneAnimationData* data, double time)
+{
+	if(data->posKeyframes.size() == 0)
+		return glm::vec3();
+	if(data->posKeyframes.size() == 1)
+		return data->posKeyframes[0]->position;
+
+	int key = FindLegacyKeyframe(data->posKeyframes, time, data->posCursor);
+	float t = (time - data->posKeyframes[key]->time) / (data->posKeyframes[key + 1]->time - data->posKeyframes[key]->time);
+
+	return lerp(data->posKeyframes[key]->position, data->posKeyframes[key + 1]->position, t);
+}
+
+static glm::quat SampleLegacyRotation(LegacyBoneAnimationData* data, double time)
+{
+	if(data->rotKeyframes.size() == 0)
+		return glm::quat();
+	if(data->rotKeyframes.size() == 1)
+		return data->rotKeyframes[0]->rotation;
+
+	int key = FindLegacyKeyframe(data->rotKeyframes, time, data->rotCursor);
+	float t = (time - data->rotKeyframes[key]->time) / (data->rotKeyframes[key + 1]->time - data->rotKeyframes[key]->time);
+
+	return glm::slerp(data->rotKeyframes[key]->rotation, data->rotKeyframes[key + 1]->rotation, t);
+}
+#pragma endregion
+
+void Benchmark::Run(std::vector<Skeleton*> skeletons)
+{
+	printf("\n\nBENCHMARK\n");
+
+	for(int i = 0; i < skeletons.size(); i++)
+	{
+		std::vector<Animation*>& animations = skeletons[i]->GetAnimations();
+
+		for(int aniIdx = 0; aniIdx < animations.size(); aniIdx++)
+			KeyframeLayouts(animations[aniIdx]);
+	}
+
+	for(int i = 0; i < skeletons.size(); i++)
+		SkinningKernels(skeletons[i]);
+
+	for(int i = 0; i < skeletons.size(); i++)
+		Transitions(skeletons[i]);
+
+	ParallelAnimation(skeletons);
+}
+
+void Benchmark::KeyframeLayouts(Animation* animation, int passes)
+{
+	const AnimationClip* clip = animation->clip;
+
+	if(clip->tracks.size() == 0 || clip->duration <= 0 || clip->compressed)
+		return;
+
+	//Rebuild the clip the way the loader used to, one allocation per key
+	std::vector<LegacyBoneAnimationData*> legacy;
+
+	for(int trackIdx = 0; trackIdx < clip->tracks.size(); trackIdx++)
+	{
+		const AnimationTrack& track = clip->tracks[trackIdx];
+		LegacyBoneAnimationData* data = new LegacyBoneAnimationData();
+
+		for(int i = 0; i < track.posCount; i++)
+		{
+			LegacyPosKeyFrame* key = new LegacyPosKeyFrame;
+			key->position = clip->posValues[track.posOffset + i];
+			key->time = clip->posTimes[track.posOffset + i];
+			data->posKeyframes.push_back(key);
+		}
+
+		for(int i = 0; i < track.rotCount; i++)
+		{
+			LegacyRotKeyFrame* key = new LegacyRotKeyFrame;
+			key->rotation = clip->rotValues[track.rotOffset + i];
+			key->time = clip->rotTimes[track.rotOffset + i];
+			data->rotKeyframes.push_back(key);
+		}
+
+		legacy.push_back(data);
+	}
+
+	const int framesPerPass = 120;
+	double step = animation->duration / framesPerPass;
+	int numSamples = passes * framesPerPass * clip->tracks.size();
+
+	float checksum = 0.0f; //Keeps the compiler from throwing the samples away
+
+	//Legacy layout
+	Timer timer;
+	for(int pass = 0; pass < passes; pass++)
+	{
+		for(int frame = 0; frame < framesPerPass; frame++)
+		{
+			double time = frame * step;
+
+			for(int trackIdx = 0; trackIdx < legacy.size(); trackIdx++)
+			{
+				checksum += SampleLegacyPosition(legacy[trackIdx], time).x;
+				checksum += SampleLegacyRotation(legacy[trackIdx], time).w;
+			}
+		}
+	}
+	double legacyTime = timer.ElapsedMilliseconds();
+
+	//Contiguous key streams
+	double savedClock = animation->localClock;
+
+	timer.Reset();
+	for(int pass = 0; pass < passes; pass++)
+	{
+		for(int frame = 0; frame < framesPerPass; frame++)
+		{
+			animation->localClock = frame * step;
+
+			for(int trackIdx = 0; trackIdx < clip->tracks.size(); trackIdx++)
+			{
+				checksum += animation->SamplePosition(trackIdx).x;
+				checksum += animation->SampleRotation(trackIdx).w;
+			}
+		}
+	}
+	double streamTime = timer.ElapsedMilliseconds();
+
+	animation->localClock = savedClock;
+	animation->ResetCursors();
+
+	for(int i = 0; i < legacy.size(); i++)
+	{
+		for(int j = 0; j < legacy[i]->posKeyframes.size(); j++)
+			delete legacy[i]->posKeyframes[j];
+		for(int j = 0; j < legacy[i]->rotKeyframes.size(); j++)
+			delete legacy[i]->rotKeyframes[j];
+
+		delete legacy[i];
+	}
+
+	printf("%s (%i tracks, %i keys)\n", clip->name.c_str(), (int)clip->tracks.size(), animation->GetNumKeys());
+	printf("    per key allocations: %.1f ns/track sample\n", legacyTime * 1000000.0 / numSamples);
+	printf("    contiguous streams:  %.1f ns/track sample (%.2fx) [%f]\n", streamTime * 1000000.0 / numSamples, legacyTime / streamTime, checksum);
+}
+
+//Another skeleton of the same rig playing the same clips, each one starting on a different clip so the crowd isn't in lockstep
+static Skeleton* CloneSkeleton(Skeleton* source, int variation)
+{
+	Skeleton* clone = new Skeleton(source->GetDefinition());
+
+	std::vector<Animation*>& animations = source->GetAnimations();
+
+	for(int aniIdx = 0; aniIdx < animations.size(); aniIdx++)
+		clone->LoadAnimation(animations[aniIdx]->GetName().c_str()); //Already in the clip library
+
+	if(animations.size() > 0)
+		clone->AddToAnimationQueue(variation % animations.size());
+
+	return clone;
+}
+
+void Benchmark::ParallelAnimation(std::vector<Skeleton*> skeletons, int numCharacters, int frames)
+{
+	std::vector<Skeleton*> sources;
+	for(int i = 0; i < skeletons.size(); i++)
+	{
+		if(skeletons[i] && skeletons[i]->GetNumBones() > 0)
+			sources.push_back(skeletons[i]);
+	}
+
+	if(sources.size() == 0)
+		return;
+
+	const double deltaTime = 1000.0 / 60.0;
+	int hardwareThreads = JobSystem::GetHardwareThreads();
+
+	printf("\nParallel animation, %i characters, %i frames\n", numCharacters, frames);
+
+	double serialTime = 0.0;
+	double serialChecksum = 0.0;
+
+	for(int threads = 1; threads <= hardwareThreads; threads++)
+	{
+		std::vector<Skeleton*> crowd;
+		for(int i = 0; i < numCharacters; i++)
+			crowd.push_back(CloneSkeleton(sources[i % sources.size()], i / sources.size()));
+
+		JobSystem jobSystem(threads - 1);
+
+		Timer timer;
+		for(int frame = 0; frame < frames; frame++)
+		{
+			jobSystem.ParallelFor(crowd.size(), [&crowd, deltaTime](int i)
+			{
+				if(crowd[i]->hasKeyframes)
+					crowd[i]->Animate(deltaTime);
+
+				crowd[i]->UpdateGlobalTransforms();
+			});
+		}
+		double time = timer.ElapsedMilliseconds();
+
+		//Summed in a fixed order, so any difference at all from the serial run shows up
+		double checksum = 0.0;
+		for(int i = 0; i < crowd.size(); i++)
+		{
+			for(int boneIdx = 0; boneIdx < crowd[i]->GetNumBones(); boneIdx++)
+			{
+				const glm::mat4& m = crowd[i]->GetFinalTransform(boneIdx);
+
+				for(int col = 0; col < 4; col++)
+					checksum += m[col][0] + m[col][1] + m[col][2] + m[col][3];
+			}
+
+			delete crowd[i];
+		}
+
+		if(threads == 1)
+		{
+			serialTime = time;
+			serialChecksum = checksum;
+		}
+
+		printf("    %2i threads: %.3f ms/frame (%.2fx) %s\n", threads, time / frames, serialTime / time, 
+			checksum == serialChecksum ? "matches serial" : "DIFFERS FROM SERIAL");
+	}
+}
+
+void Benchmark::SkinningKernels(Skeleton* skeleton, int passes)
+{
+	int numBones = skeleton ? skeleton->GetNumBones() : 0;
+
+	if(numBones == 0)
+		return;
+
+	const std::vector<int>& parentIDs = skeleton->GetParentIDs();
+	const std::vector<glm::mat4>& offsets = skeleton->GetOffsets();
+
+	//The rig's current pose split back into translations and rotations, which is what the blender works with
+	std::vector<glm::vec3> translations(numBones);
+	std::vector<glm::quat> rotations(numBones);
+
+	for(int boneIdx = 0; boneIdx < numBones; boneIdx++)
+	{
+		const glm::mat4& local = skeleton->GetLocalTransform(boneIdx);
+
+		translations[boneIdx] = glm::vec3(local[3]);
+		rotations[boneIdx] = glm::normalize(glm::quat_cast(glm::mat3(local)));
+	}
+
+	std::vector<glm::mat4> locals(numBones);
+	std::vector<glm::mat4> globals(numBones);
+	std::vector<glm::mat4> finals(numBones);
+	std::vector<glm::mat4> reference(numBones);
+
+	int numMatrices = passes * numBones;
+
+	//The old path, a translate and a toMat4 multiplied together per bone then the two products in the hierarchy
+	Timer timer;
+	for(int pass = 0; pass < passes; pass++)
+	{
+		for(int boneIdx = 0; boneIdx < numBones; boneIdx++)
+		{
+			locals[boneIdx] = glm::translate(glm::mat4(1), translations[boneIdx]) * glm::toMat4(rotations[boneIdx]);
+
+			int parentID = parentIDs[boneIdx];
+			globals[boneIdx] = parentID < 0 ? locals[boneIdx] : globals[parentID] * locals[boneIdx];
+			reference[boneIdx] = globals[boneIdx] * offsets[boneIdx];
+		}
+	}
+	double glmTime = timer.ElapsedMilliseconds();
+
+	printf("\nSkinning matrices, %i bones\n", numBones);
+	printf("    glm:    %.1f ns/bone\n", glmTime * 1000000.0 / numMatrices);
+
+	SimdLevel savedLevel = GetSimdLevel();
+
+	for(int level = SimdScalar; level <= GetSupportedSimdLevel(); level++)
+	{
+		SetSimdLevel((SimdLevel)level);
+
+		timer.Reset();
+		for(int pass = 0; pass < passes; pass++)
+		{
+			ComposeTransforms(&translations[0], &rotations[0], 0, &locals[0], numBones);
+			ComputeSkinningMatrices(&parentIDs[0], &locals[0], &offsets[0], &globals[0], &finals[0], 0, numBones);
+		}
+		double time = timer.ElapsedMilliseconds();
+
+		float maxError = 0.0f;
+		for(int boneIdx = 0; boneIdx < numBones; boneIdx++)
+		{
+			for(int col = 0; col < 4; col++)
+			{
+				for(int row = 0; row < 4; row++)
+					maxError = glm::max(maxError, glm::abs(finals[boneIdx][col][row] - reference[boneIdx][col][row]));
+			}
+		}
+
+		printf("    %-6s  %.1f ns/bone (%.2fx), max difference from glm %g\n", (std::string(GetSimdLevelName((SimdLevel)level)) + ":").c_str(), 
+			time * 1000000.0 / numMatrices, glmTime / time, maxError);
+	}
+
+	SetSimdLevel(savedLevel);
+}
+
+bool Benchmark::CpuSkinning(const char* meshFile, const std::vector<const char*>& animationFiles, int frames, int numCharacters)
+{
+	const float tolerance = 0.001f;
+
+	MeshData meshData;
+
+	if(!AssetCache::LoadMesh(meshFile, meshData))
+		return false;
+
+	CpuSkinnedMesh mesh;
+
+	if(!mesh.Init(meshData))
+		return false;
+
+	Skeleton skeleton(SkeletonDefinition::Get(meshFile, meshData));
+
+	for(int i = 0; i < animationFiles.size(); i++)
+		skeleton.LoadAnimation(animationFiles[i]);
+
+	printf("\nCPU skinning, %s (%i vertices, %i bones), %s\n", meshFile, mesh.GetNumVertices(), mesh.GetNumBones(), GetSimdLevelName(GetSimdLevel()));
+
+	const double deltaTime = 1000.0 / 60.0;
+	std::vector<glm::vec3> referencePositions;
+	std::vector<glm::vec3> referenceNormals;
+
+	double referenceTime = 0.0;
+	double skinTime = 0.0;
+	double boundsTime = 0.0;
+	float maxError = 0.0f;
+	int outsideBounds = 0; //Skinned vertices the skeleton's bounds missed, over every frame
+
+	//Every clip in turn, so the check covers more than the bind pose
+	int numClips = glm::max((int)animationFiles.size(), 1);
+
+	for(int frame = 0; frame < frames; frame++)
+	{
+		if(frame % (frames / numClips + 1) == 0)
+			skeleton.AddToAnimationQueue(frame / (frames / numClips + 1));
+
+		if(skeleton.hasKeyframes)
+			skeleton.Animate(deltaTime);
+
+		skeleton.UpdateGlobalTransforms();
+
+		const glm::mat4* boneTransforms = skeleton.GetFinalTransforms();
+
+		Timer timer;
+		mesh.SkinReference(boneTransforms, referencePositions, referenceNormals);
+		referenceTime += timer.ElapsedMilliseconds();
+
+		timer.Reset();
+		mesh.Skin(boneTransforms);
+		skinTime += timer.ElapsedMilliseconds();
+
+		maxError = glm::max(maxError, mesh.Verify(boneTransforms));
+
+		timer.Reset();
+		BoundingBox bounds = skeleton.GetSkinnedBounds();
+		boundsTime += timer.ElapsedMilliseconds();
+
+		for(int i = 0; i < referencePositions.size(); i++)
+		{
+			glm::vec3 margin = glm::max(glm::abs(referencePositions[i]), glm::vec3(1.0f)) * tolerance;
+
+			if(glm::any(glm::lessThan(referencePositions[i] + margin, bounds.min)) || glm::any(glm::greaterThan(referencePositions[i] - margin, bounds.max)))
+				outsideBounds++;
+		}
+	}
+
+	printf("    reference: %.3f ms/mesh\n", referenceTime / frames);
+	printf("    skin:      %.3f ms/mesh (%.2fx), max difference from reference %g %s\n", skinTime / frames, referenceTime / skinTime, 
+		maxError, maxError <= tolerance ? "" : "TOO LARGE");
+	printf("    bounds:    %.3f us/mesh from %i bones, %i vertices outside %s\n", boundsTime * 1000.0 / frames, skeleton.GetNumBones(), outsideBounds,
+		outsideBounds == 0 ? "" : "NOT CONSERVATIVE");
+
+	//A crowd all in the last pose, skinned one mesh per job
+	std::vector<CpuSkinnedMesh*> crowd;
+	std::vector<const glm::mat4*> palettes;
+
+	for(int i = 0; i < numCharacters; i++)
+	{
+		crowd.push_back(new CpuSkinnedMesh(mesh));
+		palettes.push_back(skeleton.GetFinalTransforms());
+	}
+
+	JobSystem* previous = JobSystem::Instance;
+	double serialTime = 0.0;
+
+	for(int threads = 1; threads <= JobSystem::GetHardwareThreads(); threads *= 2)
+	{
+		JobSystem jobSystem(threads - 1);
+		jobSystem.Init();
+
+		Timer timer;
+		CpuSkinnedMesh::SkinAll(crowd, palettes);
+		double time = timer.ElapsedMilliseconds();
+
+		if(threads == 1)
+			serialTime = time;
+
+		printf("    %i meshes on %2i threads: %.3f ms (%.2fx)\n", numCharacters, threads, time, serialTime / time);
+	}
+
+	JobSystem::Instance = previous;
+
+	for(int i = 0; i < crowd.size(); i++)
+		delete crowd[i];
+
+	return maxError <= tolerance && outsideBounds == 0;
+}
+
+void Benchmark::Transitions(Skeleton* skeleton, int transitions, float blendDuration)
+{
+	if(!skeleton || skeleton->GetAnimations().size() < 2)
+		return;
+
+	const double deltaTime = 1000.0 / 60.0;
+	int framesPerTransition = int(blendDuration * 60.0f) + 2; //Enough for the crossfade to finish
+	int numAnimations = skeleton->GetAnimations().size();
+
+	printf("\nTransitions, %i bones, %i frames each\n", skeleton->GetNumBones(), framesPerTransition);
+
+	double smoothTime = 0.0;
+	TransitionType types[] = { TransitionType::Smooth, TransitionType::Inertialized };
+	const char* names[] = { "crossfade:      ", "inertialization:" };
+
+	for(int typeIdx = 0; typeIdx < 2; typeIdx++)
+	{
+		Skeleton* clone = CloneSkeleton(skeleton, 0);
+
+		//Settle into the first animation before timing anything
+		for(int frame = 0; frame < 10; frame++)
+			clone->Animate(deltaTime);
+
+		Timer timer;
+		for(int i = 0; i < transitions; i++)
+		{
+			clone->AddToAnimationQueue((i + 1) % numAnimations, true, blendDuration, types[typeIdx]);
+
+			for(int frame = 0; frame < framesPerTransition; frame++)
+				clone->Animate(deltaTime);
+		}
+		double time = timer.ElapsedMilliseconds();
+
+		if(typeIdx == 0)
+			smoothTime = time;
+
+		printf("    %s %.3f ms/transition (%.2fx)\n", names[typeIdx], time / transitions, smoothTime / time);
+
+		delete clone;
+	}
+}
+
+#pragma region STAGES
+static FILE* resultsFile = 0;
+static std::string resultsLabel;
+
+bool Benchmark::OpenResults(const char* fileName, const char* label)
+{
+	CloseResults();
+
+	//Added to rather than overwritten, so runs from different commits end up in the same file
+	FILE* existing = fopen(fileName, "r");
+	bool writeHeader = existing == 0;
+
+	if(existing)
+		fclose(existing);
+
+	resultsFile = fopen(fileName, "a");
+
+	if(!resultsFile)
+	{
+		fprintf(stderr, "Couldn't open %s for the benchmark results\n", fileName);
+		return false;
+	}
+
+	resultsLabel = label;
+
+	if(writeHeader)
+		fprintf(resultsFile, "label,character,stage,instances,bones,frames,ms_per_frame,us_per_character,ns_per_bone\n");
+
+	return true;
+}
+
+void Benchmark::CloseResults()
+{
+	if(resultsFile)
+		fclose(resultsFile);
+
+	resultsFile = 0;
+}
+
+static void ReportStage(const char* character, const char* stage, int instances, int numBones, int frames, double time)
+{
+	double msPerFrame = time / frames;
+	double usPerCharacter = msPerFrame * 1000.0 / instances;
+	double nsPerBone = usPerCharacter * 1000.0 / numBones;
+
+	printf("    %-10s %4i instances: %9.3f ms/frame %9.3f us/character %8.1f ns/bone\n", stage, instances, msPerFrame, usPerCharacter, nsPerBone);
+
+	if(resultsFile)
+	{
+		fprintf(resultsFile, "%s,%s,%s,%i,%i,%i,%.6f,%.6f,%.3f\n", resultsLabel.c_str(), character, stage, instances, numBones, frames, 
+			msPerFrame, usPerCharacter, nsPerBone);
+	}
+}
+
+//The deepest bone in the rig and its closest ancestors, root end first with the effector last, as ComputeIK wants them
+static std::vector<Bone*> LongestChain(Skeleton* skeleton, int maxLinks = 4)
+{
+	const std::vector<int>& parentIDs = skeleton->GetParentIDs();
+	std::vector<int> depths(parentIDs.size());
+	int deepest = 0;
+
+	for(int boneIdx = 0; boneIdx < parentIDs.size(); boneIdx++) //Parents come first, so their depth is already known
+	{
+		depths[boneIdx] = parentIDs[boneIdx] < 0 ? 0 : depths[parentIDs[boneIdx]] + 1;
+
+		if(depths[boneIdx] > depths[deepest])
+			deepest = boneIdx;
+	}
+
+	std::vector<Bone*> chain;
+	for(int boneID = deepest; boneID >= 0 && chain.size() < maxLinks; boneID = parentIDs[boneID])
+		chain.push_back(skeleton->GetBone(boneID));
+
+	std::reverse(chain.begin(), chain.end());
+
+	return chain;
+}
+
+void Benchmark::Stages(const char* meshFile, const std::vector<const char*>& animationFiles, int instanceFrames)
+{
+	MeshData meshData;
+
+	if(!AssetCache::LoadMesh(meshFile, meshData))
+		return;
+
+	CpuSkinnedMesh mesh;
+	bool skinned = mesh.Init(meshData);
+
+	Skeleton source(SkeletonDefinition::Get(meshFile, meshData));
+
+	for(int i = 0; i < animationFiles.size(); i++)
+		source.LoadAnimation(animationFiles[i]);
+
+	int numBones = source.GetNumBones();
+
+	if(numBones == 0 || !source.hasKeyframes)
+	{
+		fprintf(stderr, "%s has no animated skeleton to time\n", meshFile);
+		return;
+	}
+
+	std::vector<Bone*> chain = LongestChain(&source);
+	const std::string chainName = "benchmark";
+
+	printf("\nStages, %s (%i bones, %i vertices, IK chain of %i)\n", meshFile, numBones, skinned ? mesh.GetNumVertices() : 0, (int)chain.size());
+
+	const double deltaTime = 1000.0 / 60.0;
+	const glm::mat4 modelMatrix(1); //So the IK targets are in mesh space
+	const int ikSteps = 10;
+
+	const int instanceCounts[] = { 1, 10, 100, 1000 };
+	const char* stageNames[] = { "sample", "blend", "hierarchy", "ik", "skinning" };
+
+	//Rigs past PARALLEL_BONE_THRESHOLD would blend on the job system, these numbers are for one core
+	JobSystem* previous = JobSystem::Instance;
+	JobSystem::Instance = 0;
+
+	for(int countIdx = 0; countIdx < ARRAY_SIZE_IN_ELEMENTS(instanceCounts); countIdx++)
+	{
+		int instances = instanceCounts[countIdx];
+		int frames = glm::max(instanceFrames / instances, 2); //About the same amount of work whatever the crowd size
+
+		std::vector<Skeleton*> crowd;
+		std::vector<glm::vec3> targets;
+
+		for(int i = 0; i < instances; i++)
+		{
+			Skeleton* clone = CloneSkeleton(&source, i);
+			clone->DefineIKChain(chainName, chain);
+
+			clone->Animate(0.0); //Starts the queued animation
+
+			//Spread out through their clips, so the crowd isn't sampling the same keys
+			std::vector<Animation*>& animations = clone->GetAnimations();
+			for(int aniIdx = 0; aniIdx < animations.size(); aniIdx++)
+				animations[aniIdx]->localClock = fmod(i * 0.137, animations[aniIdx]->duration);
+
+			clone->Animate(0.0);
+			clone->UpdateGlobalTransforms();
+
+			//The effector swung 45 degrees about the top of the chain, somewhere it can always reach
+			glm::vec3 target = clone->GetMeshSpacePosition(chain.back()->id);
+
+			if(chain.size() > 1)
+			{
+				glm::vec3 top = clone->GetMeshSpacePosition(chain.front()->id);
+				glm::vec3 reach = target - top;
+				glm::vec3 axis = glm::cross(reach, glm::vec3(0, 1, 0));
+
+				if(glm::length(axis) < 0.0001f)
+					axis = glm::vec3(1, 0, 0);
+
+				target = top + glm::vec3(glm::rotate(glm::mat4(1), 45.0f, glm::normalize(axis)) * glm::vec4(reach, 0));
+			}
+
+			crowd.push_back(clone);
+			targets.push_back(target);
+		}
+
+		double times[ARRAY_SIZE_IN_ELEMENTS(stageNames)] = { 0.0 };
+
+		for(int frame = 0; frame < frames; frame++)
+		{
+			//Animate's clock update, done here so the stages can be timed apart
+			for(int i = 0; i < instances; i++)
+			{
+				std::vector<Animation*>& animations = crowd[i]->GetAnimations();
+
+				for(int aniIdx = 0; aniIdx < animations.size(); aniIdx++)
+					animations[aniIdx]->localClock = fmod(animations[aniIdx]->localClock + deltaTime / 1000, animations[aniIdx]->duration);
+			}
+
+			Timer timer;
+			for(int i = 0; i < instances; i++)
+				crowd[i]->SampleKeyframes();
+			times[0] += timer.ElapsedMilliseconds();
+
+			timer.Reset();
+			for(int i = 0; i < instances; i++)
+			{
+				for(int boneIdx = 0; boneIdx < numBones; boneIdx++)
+					crowd[i]->BlendPose(boneIdx);
+			}
+			times[1] += timer.ElapsedMilliseconds();
+
+			timer.Reset();
+			for(int i = 0; i < instances; i++)
+				crowd[i]->UpdateGlobalTransforms();
+			times[2] += timer.ElapsedMilliseconds();
+
+			if(chain.size() > 1)
+			{
+				timer.Reset();
+				for(int i = 0; i < instances; i++)
+					crowd[i]->ComputeIK(chainName, targets[i], ikSteps, modelMatrix);
+				times[3] += timer.ElapsedMilliseconds();
+			}
+
+			//One mesh skinned with each pose in turn, a copy per instance would only measure how much memory there is
+			if(skinned)
+			{
+				timer.Reset();
+				for(int i = 0; i < instances; i++)
+					mesh.Skin(crowd[i]->GetFinalTransforms());
+				times[4] += timer.ElapsedMilliseconds();
+			}
+		}
+
+		for(int stage = 0; stage < ARRAY_SIZE_IN_ELEMENTS(stageNames); stage++)
+		{
+			if((stage == 3 && chain.size() < 2) || (stage == 4 && !skinned))
+				continue;
+
+			ReportStage(meshFile, stageNames[stage], instances, numBones, frames, times[stage]);
+		}
+
+		for(int i = 0; i < crowd.size(); i++)
+			delete crowd[i];
+	}
+
+	JobSystem::Instance = previous;
+}
+#pragma endregion
+
+bool Benchmark::RenderQueueSort(int numModels, int passes)
+{
+	const int numPrograms = 5;
+	const int numTextures = 64;
+
+	//Made up once, then added in the same shuffled order every pass, as a level's objects would be
+	std::vector<DrawItem> draws;
+	unsigned int random = 12345;
+
+	for(int model = 0; model < numModels; model++)
+	{
+		random = random * 1103515245 + 12345;
+
+		DrawItem item;
+		item.program = 1 + (random >> 16) % numPrograms;
+		item.vao = 1 + model;
+		item.wireframe = (random >> 8) % 50 == 0;
+
+		int meshEntries = 1 + (random >> 20) % 4;
+
+		for(int entry = 0; entry < meshEntries; entry++)
+		{
+			random = random * 1103515245 + 12345;
+
+			item.texture = (random >> 16) % 8 == 0 ? RENDER_ANY_TEXTURE : 1 + (random >> 16) % numTextures;
+			item.numIndices = 3 * (1 + (random >> 4) % 1000);
+			item.matrix = model;
+
+			draws.push_back(item);
+		}
+	}
+
+	for(int i = draws.size() - 1; i > 0; i--)
+	{
+		random = random * 1103515245 + 12345;
+		std::swap(draws[i], draws[(random >> 8) % (i + 1)]);
+	}
+
+	RenderQueue queue;
+	glm::mat4 matrix(1);
+
+	Timer timer;
+	for(int pass = 0; pass < passes; pass++)
+	{
+		queue.Clear();
+
+		for(int model = 0; model < numModels; model++)
+			queue.AddMatrix(matrix);
+
+		for(int i = 0; i < draws.size(); i++)
+			queue.Add(draws[i]);
+
+		queue.Sort();
+	}
+	double time = timer.ElapsedMilliseconds();
+
+	//Every draw exactly once, keys never going down, and equal keys left in the order they were added
+	bool passed = queue.GetNumItems() == draws.size();
+	std::vector<int> seen(draws.size(), 0);
+
+	for(int i = 0; i < queue.GetNumItems() && passed; i++)
+	{
+		int added = queue.GetAddedIndex(i);
+
+		passed = added >= 0 && added < draws.size() && seen[added]++ == 0 && RenderQueue::MakeKey(queue.GetItem(i)) == queue.GetKey(i);
+
+		if(i > 0)
+		{
+			passed = passed && (queue.GetKey(i - 1) < queue.GetKey(i) || 
+				(queue.GetKey(i - 1) == queue.GetKey(i) && queue.GetAddedIndex(i - 1) < added));
+		}
+	}
+
+	RenderStats unsorted = queue.CountStateChanges(false);
+	RenderStats sorted = queue.CountStateChanges(true);
+
+	printf("\nRender queue, %i models, %i draws\n", numModels, (int)draws.size());
+	printf("    build and sort: %.3f ms/frame\n", time / passes);
+	printf("    switches as added: %i programs, %i VAOs, %i textures\n", unsorted.programSwitches, unsorted.vaoSwitches, unsorted.textureSwitches);
+	printf("    switches sorted:   %i programs, %i VAOs, %i textures %s\n", sorted.programSwitches, sorted.vaoSwitches, sorted.textureSwitches,
+		passed ? "" : "SORT IS WRONG");
+
+	return passed;
+}
+
+bool Benchmark::Culling(int numObjects, int passes)
+{
+	//Spheres scattered through a box around a camera at the origin, about half of them in view
+	std::vector<BoundingSphere> spheres;
+	unsigned int random = 54321;
+
+	for(int i = 0; i < numObjects; i++)
+	{
+		glm::vec3 center;
+		for(int axis = 0; axis < 3; axis++)
+		{
+			random = random * 1103515245 + 12345;
+			center[axis] = ((random >> 8) % 20001) / 100.0f - 100.0f;
+		}
+
+		random = random * 1103515245 + 12345;
+		spheres.push_back(BoundingSphere(center, 0.5f + ((random >> 8) % 500) / 100.0f));
+	}
+
+	glm::mat4 viewProjection = glm::perspective(60.0f, 16.0f / 9.0f, 0.1f, 150.0f) * glm::lookAt(glm::vec3(0), glm::vec3(0.3f, 0, 1), glm::vec3(0, 1, 0));
+	Frustum frustum = Frustum::FromMatrix(viewProjection);
+
+	std::vector<unsigned char> reference(numObjects);
+	int referenceVisible = 0;
+
+	Timer timer;
+	for(int pass = 0; pass < passes; pass++)
+	{
+		referenceVisible = 0;
+
+		for(int i = 0; i < numObjects; i++)
+		{
+			reference[i] = frustum.Intersects(spheres[i]) ? 1 : 0;
+			referenceVisible += reference[i];
+		}
+	}
+	double scalarTime = timer.ElapsedMilliseconds();
+
+	CullingBatch batch;
+
+	timer.Reset();
+	for(int pass = 0; pass < passes; pass++)
+	{
+		batch.Clear();
+
+		for(int i = 0; i < numObjects; i++)
+			batch.Add(spheres[i]);
+
+		batch.Cull(frustum);
+	}
+	double batchTime = timer.ElapsedMilliseconds();
+
+	bool passed = batch.GetNumVisible() == referenceVisible;
+
+	for(int i = 0; i < numObjects && passed; i++)
+		passed = batch.IsVisible(i) == (reference[i] != 0);
+
+	printf("\nFrustum culling, %i spheres, %i visible\n", numObjects, referenceVisible);
+	printf("    one at a time: %.3f ms/frame\n", scalarTime / passes);
+	printf("    batch (%s, filled and culled): %.3f ms/frame %s\n", GetSimdLevel() >= SimdSSE ? "SSE" : "scalar", batchTime / passes,
+		passed ? "" : "RESULTS DIFFER");
+
+	return passed;
+}
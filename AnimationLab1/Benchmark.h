@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "Animation.h"
+
+class Skeleton;
+
+//Timings for the animation hot paths, run with -benchmark on the command line.
+//Results are printed to the console.
+class Benchmark
+{
+	public:
+
+		static void Run(std::vector<Skeleton*> skeletons);
+
+		//Sampling throughput of the contiguous key streams against a vector of individually allocated keys per channel
+		static void KeyframeLayouts(Animation* animation, int passes = 200);
+
+		//Frame time for a crowd of copies of the given skeletons, on 1 thread up to every hardware thread.
+		//Also checks every thread count ends up with exactly the pose the serial run did.
+		static void ParallelAnimation(std::vector<Skeleton*> skeletons, int numCharacters = 256, int frames = 120);
+
+		//Local, global and skinning matrices for every bone of the skeleton's rig, built the old way with glm
+		//and with the batch kernels at every SIMD level the CPU supports
+		static void SkinningKernels(Skeleton* skeleton, int passes = 2000);
+
+		//What a transition costs with a crossfade, which samples both animations until it's over, against inertialization
+		static void Transitions(Skeleton* skeleton, int transitions = 200, float blendDuration = 0.25f);
+
+		//CPU skinning against the reference, through the mesh's animations, then a crowd of copies skinned on every thread.
+		//Also checks the skeleton's skinned bounds hold every vertex. Needs no window, returns false if the fast path strays
+		//from the reference or a vertex is outside the bounds.
+		static bool CpuSkinning(const char* meshFile, const std::vector<const char*>& animationFiles, int frames = 120, int numCharacters = 64);
+
+		//Keyframe sampling, blending, the hierarchy update, IK and CPU skinning timed one at a time, for 1, 10, 100 and 1000
+		//copies of the character. Runs on one thread so the numbers are per core. Needs no window.
+		static void Stages(const char* meshFile, const std::vector<const char*>& animationFiles, int instanceFrames = 2000);
+
+		//Builds and sorts a render queue of made up models, a few shaders, a VAO each and textures from a shared pool,
+		//then checks every draw came out once and in key order. Needs no GL. Returns false if the sort went wrong.
+		static bool RenderQueueSort(int numModels = 2000, int passes = 50);
+
+		//Frustum culling a scatter of spheres one at a time against the batch, which uses SSE when the CPU has it.
+		//Needs no GL. Returns false if the two disagree about any sphere.
+		static bool Culling(int numObjects = 10000, int passes = 200);
+
+		//A CSV file Stages adds a row to per measurement, for tracking results across commits. label goes in every row, e.g. a commit hash.
+		static bool OpenResults(const char* fileName, const char* label = "");
+		static void CloseResults();
+};
@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+#include "Skeleton.h"
+#include "JobSystem.h"
+
+#include <stdio.h>
+#include <string.h>
+
+//The animation benchmarks on their own, for the runtime library built without the game (see CMakeLists.txt).
+//Characters are given as -mesh followed by the clips to load on it, e.g.
+//    AnimationBenchmark -mesh Models/sora.dae Animations/sora_brisk_walk.dae -mesh Models/don1.dae Animations/don_walk.dae
+//with no arguments it runs on the game's two characters. Builds without assimp can only read baked assets, bake them with -bake.
+//-results file.csv adds a row per stage timing to the file, tagged with the text given to -label (a commit hash, say),
+//so runs from different commits can be compared.
+
+struct BenchmarkCharacter
+{
+	const char* meshFile;
+	std::vector<const char*> clipFiles;
+};
+
+static Skeleton* LoadCharacter(const BenchmarkCharacter& character)
+{
+	MeshData mesh;
+
+	if(!AssetCache::LoadMesh(character.meshFile, mesh))
+		return 0;
+
+	if(mesh.bones.size() == 0)
+	{
+		fprintf(stderr, "%s has no skeleton\n", character.meshFile);
+		return 0;
+	}
+
+	Skeleton* skeleton = new Skeleton(SkeletonDefinition::Get(character.meshFile, mesh));
+
+	for(int i = 0; i < character.clipFiles.size(); i++)
+		skeleton->LoadAnimation(character.clipFiles[i]);
+
+	skeleton->AddToAnimationQueue(0);
+
+	return skeleton;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<BenchmarkCharacter> characters;
+	const char* resultsFile = 0;
+	const char* label = "";
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-results") == 0 && i + 1 < argc)
+		{
+			resultsFile = argv[++i];
+		}
+		else if(strcmp(argv[i], "-label") == 0 && i + 1 < argc)
+		{
+			label = argv[++i];
+		}
+		else if(strcmp(argv[i], "-mesh") == 0 && i + 1 < argc)
+		{
+			BenchmarkCharacter character;
+			character.meshFile = argv[++i];
+			characters.push_back(character);
+		}
+		else if(characters.size() > 0)
+		{
+			characters.back().clipFiles.push_back(argv[i]);
+		}
+		else
+		{
+			fprintf(stderr, "usage: %s [-results file.csv] [-label text] [-mesh meshFile clipFile...]...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if(characters.size() == 0)
+	{
+		BenchmarkCharacter sora;
+		sora.meshFile = "Models/sora.dae";
+		sora.clipFiles.push_back("Animations/sora_idle_accad_female_look.dae");
+		sora.clipFiles.push_back("Animations/sora_brisk_walk.dae");
+		sora.clipFiles.push_back("Animations/sora_punch_cmu_02_05.dae");
+		characters.push_back(sora);
+
+		BenchmarkCharacter donald;
+		donald.meshFile = "Models/don1.dae";
+		donald.clipFiles.push_back("Animations/don_walk.dae");
+		donald.clipFiles.push_back("Animations/don_wave.dae");
+		donald.clipFiles.push_back("Animations/don_angry_talk_cmu_79_74.dae");
+		donald.clipFiles.push_back("Animations/don_happy_talk_cmu_happy.dae");
+		characters.push_back(donald);
+	}
+
+	if(resultsFile && !Benchmark::OpenResults(resultsFile, label))
+		return 1;
+
+	JobSystem jobSystem;
+	jobSystem.Init();
+
+	std::vector<Skeleton*> skeletons;
+
+	for(int i = 0; i < characters.size(); i++)
+	{
+		Skeleton* skeleton = LoadCharacter(characters[i]);
+
+		if(skeleton)
+			skeletons.push_back(skeleton);
+	}
+
+	if(skeletons.size() == 0)
+	{
+		fprintf(stderr, "Nothing to benchmark, none of the characters loaded\n");
+		return 1;
+	}
+
+	Benchmark::Run(skeletons);
+
+	bool passed = true;
+
+	for(int i = 0; i < characters.size(); i++)
+		passed = Benchmark::CpuSkinning(characters[i].meshFile, characters[i].clipFiles) && passed;
+
+	for(int i = 0; i < characters.size(); i++)
+		Benchmark::Stages(characters[i].meshFile, characters[i].clipFiles);
+
+	passed = Benchmark::RenderQueueSort() && passed;
+	passed = Benchmark::Culling() && passed;
+
+	Benchmark::CloseResults();
+
+	for(int i = 0; i < skeletons.size(); i++)
+		delete skeletons[i];
+
+	return passed ? 0 : 1;
+}
@@ -1,9 +1,6 @@
 #ifndef _CAMERA_H                // Prevent multiple definitions if this 
 #define _CAMERA_H                // file is included in more than one place
 
-#include <GL/glew.h>
-#include <GL/freeglut.h>
-
 #include <string> 
 #include <fstream>
 #include <iostream>
@@ -89,7 +86,7 @@ class Camera
 			verticalAngle += turnSpeed * deltaTime * float(winh/2 - inputY);
 		}
 
-		void Zoom(GLfloat amount)
+		void Zoom(float amount)
 		{
 			if(mode == CameraMode::tp)
 			{
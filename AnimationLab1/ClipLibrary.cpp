@@ -0,0 +1,87 @@
+#include "ClipLibrary.h"
+#include "AssetCache.h"
+
+#include <stdio.h>
+
+std::map<std::string, AnimationClip*> ClipLibrary::clips;
+std::map<std::string, std::vector<int>*> ClipLibrary::bindings;
+
+bool ClipLibrary::CompressClips = false;
+float ClipLibrary::CompressionPositionTolerance = 0.001f;
+float ClipLibrary::CompressionRotationTolerance = 0.0005f;
+
+const AnimationClip* ClipLibrary::GetClip(const char* fileName)
+{
+	std::map<std::string, AnimationClip*>::iterator found = clips.find(fileName);
+
+	if(found != clips.end())
+		return found->second;
+
+	ClipData data;
+
+	if(!AssetCache::LoadClip(fileName, data))
+		return 0;
+
+	AnimationClip* clip = new AnimationClip(fileName, data.duration);
+
+	clip->trackNames.swap(data.trackNames);
+	clip->tracks.swap(data.tracks);
+	clip->posTimes.swap(data.posTimes);
+	clip->posValues.swap(data.posValues);
+	clip->rotTimes.swap(data.rotTimes);
+	clip->rotValues.swap(data.rotValues);
+
+	if(CompressClips && clip->tracks.size() > 0)
+	{
+		CompressionReport report = CompressAnimation(clip, CompressionPositionTolerance, CompressionRotationTolerance);
+
+		printf("Compressed %s: %i -> %i bytes (%.1f%% saved), kept %i of %i keys, max error %f units / %f radians\n", fileName,
+			report.rawBytes, report.compressedBytes, 100.0f * (1.0f - float(report.compressedBytes) / report.rawBytes),
+			report.keptKeys, report.rawKeys, report.maxPositionError, report.maxRotationError);
+	}
+
+	clips[fileName] = clip;
+
+	return clip;
+}
+
+const std::vector<int>* ClipLibrary::GetBinding(const AnimationClip* clip, const SkeletonDefinition* rig)
+{
+	std::string key = clip->name + '\n' + rig->GetRigKey();
+	std::map<std::string, std::vector<int>*>::iterator found = bindings.find(key);
+
+	if(found != bindings.end())
+		return found->second;
+
+	std::vector<int>* boneIDs = new std::vector<int>(clip->tracks.size(), -1);
+
+	for(int trackIdx = 0; trackIdx < clip->tracks.size(); trackIdx++)
+	{
+		int boneID = rig->GetBoneID(clip->trackNames[trackIdx]);
+
+		if(boneID < 0)
+		{
+			fprintf (stderr, "\nWARNING: did not find node named %s in skeleton."
+				"animation broken.\n", clip->trackNames[trackIdx].c_str());
+			continue;
+		}
+
+		(*boneIDs)[trackIdx] = boneID;
+	}
+
+	bindings[key] = boneIDs;
+
+	return boneIDs;
+}
+
+void ClipLibrary::Clear()
+{
+	for(std::map<std::string, AnimationClip*>::iterator it = clips.begin(); it != clips.end(); ++it)
+		delete it->second;
+
+	for(std::map<std::string, std::vector<int>*>::iterator it = bindings.begin(); it != bindings.end(); ++it)
+		delete it->second;
+
+	clips.clear();
+	bindings.clear();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Animation.h"
+#include "SkeletonDefinition.h"
+
+//Every animation clip the process has loaded, keyed by file path. A clip is read (from its bake if there is one)
+//the first time any skeleton asks for it and shared by all of them after that, along with the mapping from its
+//tracks to the bones of each rig that plays it, so another character with the same rig costs only its playback state.
+class ClipLibrary
+{
+	private:
+
+		static std::map<std::string, AnimationClip*> clips;
+		static std::map<std::string, std::vector<int>*> bindings; //Keyed by clip path and rig
+
+	public:
+
+		static bool CompressClips; //Quantize and reduce keys as clips are loaded
+		static float CompressionPositionTolerance;
+		static float CompressionRotationTolerance; //Radians
+
+		//The clip loaded from fileName, or 0 if it couldn't be
+		static const AnimationClip* GetClip(const char* fileName);
+
+		//The bone ID each of clip's tracks drives, -1 for tracks with no bone of that name. Only the first
+		//skeleton of each rig (by its rig key) has its names looked up.
+		static const std::vector<int>* GetBinding(const AnimationClip* clip, const SkeletonDefinition* rig);
+
+		static int GetNumClips() { return clips.size(); }
+		static int GetNumBindings() { return bindings.size(); }
+
+		//Only once nothing is playing any of the clips
+		static void Clear();
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#define MAX_BONES 32 
+#define PALETTE_TEXTURE_UNIT 1 //Where the skinned shaders find the bone matrices, see SkinningPalette.h
 #define ARRAY_SIZE_IN_ELEMENTS(a) (sizeof(a)/sizeof(a[0]))
 #define PRECISION 3
 
@@ -0,0 +1,228 @@
+#include "CpuSkinning.h"
+#include "SkinningKernel.h"
+#include "JobSystem.h"
+
+#include <stdio.h>
+#include <float.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPU_SKINNING_SSE
+
+#include <emmintrin.h>
+
+#ifdef _MSC_VER
+#define TARGET_SSE
+#else
+#define TARGET_SSE __attribute__((target("sse2")))
+#endif
+
+#endif
+
+//A vertex with no weight on it has no normal left to normalise, so it keeps a zero one
+static glm::vec3 NormalizeOrZero(const glm::vec3& normal)
+{
+	float length = glm::length(normal);
+
+	return length > 0.0f ? normal / length : glm::vec3(0.0f);
+}
+
+bool CpuSkinnedMesh::Init(const MeshData& mesh)
+{
+	if(mesh.bones.size() == 0 || mesh.vertexWeights.size() != mesh.positions.size())
+	{
+		fprintf(stderr, "Can't skin on the CPU, the mesh has no skinning data\n");
+		return false;
+	}
+
+	numBones = mesh.bones.size();
+
+	bindPositions = mesh.positions;
+	vertexWeights = mesh.vertexWeights;
+
+	//Meshes without normals still get some, so callers don't need to check
+	if(mesh.normals.size() == mesh.positions.size())
+		bindNormals = mesh.normals;
+	else
+		bindNormals.assign(mesh.positions.size(), glm::vec3(0, 1, 0));
+
+	for(int vertID = 0; vertID < vertexWeights.size(); vertID++)
+	{
+		for(int k = 0; k < NUM_WEIGHTS_PER_VERTEX; k++)
+		{
+			if(vertexWeights[vertID].boneIDs[k] >= numBones)
+			{
+				fprintf(stderr, "Can't skin on the CPU, vertex %i is weighted to bone %u of %i\n", vertID, vertexWeights[vertID].boneIDs[k], numBones);
+				return false;
+			}
+		}
+	}
+
+	positions = bindPositions;
+	normals = bindNormals;
+
+	return true;
+}
+
+void CpuSkinnedMesh::Skin(const glm::mat4* boneTransforms)
+{
+#ifdef CPU_SKINNING_SSE
+	if(GetSimdLevel() >= SimdSSE)
+	{
+		SkinSSE(boneTransforms);
+		return;
+	}
+#endif
+
+	SkinScalar(boneTransforms);
+}
+
+void CpuSkinnedMesh::SkinReference(const glm::mat4* boneTransforms, std::vector<glm::vec3>& referencePositions, std::vector<glm::vec3>& referenceNormals)
+{
+	int numVertices = bindPositions.size();
+
+	referencePositions.resize(numVertices);
+	referenceNormals.resize(numVertices);
+
+	for(int vertID = 0; vertID < numVertices; vertID++)
+	{
+		const VertexWeight& weight = vertexWeights[vertID];
+
+		glm::mat4 boneTransform = boneTransforms[weight.boneIDs[0]] * weight.weights[0];
+		boneTransform += boneTransforms[weight.boneIDs[1]] * weight.weights[1];
+		boneTransform += boneTransforms[weight.boneIDs[2]] * weight.weights[2];
+		boneTransform += boneTransforms[weight.boneIDs[3]] * weight.weights[3];
+
+		referencePositions[vertID] = glm::vec3(boneTransform * glm::vec4(bindPositions[vertID], 1.0f));
+		referenceNormals[vertID] = NormalizeOrZero(glm::vec3(boneTransform * glm::vec4(bindNormals[vertID], 0.0f)));
+	}
+}
+
+float CpuSkinnedMesh::Verify(const glm::mat4* boneTransforms)
+{
+	std::vector<glm::vec3> referencePositions;
+	std::vector<glm::vec3> referenceNormals;
+
+	Skin(boneTransforms);
+	SkinReference(boneTransforms, referencePositions, referenceNormals);
+
+	float maxError = 0.0f;
+
+	for(int vertID = 0; vertID < positions.size(); vertID++)
+	{
+		glm::vec3 positionError = glm::abs(positions[vertID] - referencePositions[vertID]);
+		glm::vec3 normalError = glm::abs(normals[vertID] - referenceNormals[vertID]);
+
+		//NaN compares false with everything, so it would never raise maxError
+		if(glm::any(glm::isnan(positionError)) || glm::any(glm::isnan(normalError)))
+			return FLT_MAX;
+
+		maxError = glm::max(maxError, glm::max(positionError.x, glm::max(positionError.y, positionError.z)));
+		maxError = glm::max(maxError, glm::max(normalError.x, glm::max(normalError.y, normalError.z)));
+	}
+
+	return maxError;
+}
+
+//Same as the reference, but skipping the unused influences most vertices have
+void CpuSkinnedMesh::SkinScalar(const glm::mat4* boneTransforms)
+{
+	int numVertices = bindPositions.size();
+
+	for(int vertID = 0; vertID < numVertices; vertID++)
+	{
+		const VertexWeight& weight = vertexWeights[vertID];
+
+		glm::mat4 boneTransform = boneTransforms[weight.boneIDs[0]] * weight.weights[0];
+
+		for(int k = 1; k < NUM_WEIGHTS_PER_VERTEX; k++)
+		{
+			if(weight.weights[k] != 0.0f)
+				boneTransform += boneTransforms[weight.boneIDs[k]] * weight.weights[k];
+		}
+
+		positions[vertID] = glm::vec3(boneTransform * glm::vec4(bindPositions[vertID], 1.0f));
+		normals[vertID] = NormalizeOrZero(glm::vec3(boneTransform * glm::vec4(bindNormals[vertID], 0.0f)));
+	}
+}
+
+#ifdef CPU_SKINNING_SSE
+//Each column of the blended bone matrix sits in one register, so a vertex is 4 multiply-adds per influence
+//to blend and 4 more to transform, with the weights and coordinates broadcast across the lanes.
+//A lane per vertex instead was slower: each lane blends different bones, so their columns have to be gathered and
+//transposed into place, which costs more than the structure of arrays transform and normalise save.
+TARGET_SSE void CpuSkinnedMesh::SkinSSE(const glm::mat4* boneTransforms)
+{
+	int numVertices = bindPositions.size();
+
+	for(int vertID = 0; vertID < numVertices; vertID++)
+	{
+		const VertexWeight& weight = vertexWeights[vertID];
+
+		const float* bone = &boneTransforms[weight.boneIDs[0]][0][0];
+		__m128 w = _mm_set1_ps(weight.weights[0]);
+
+		__m128 c0 = _mm_mul_ps(_mm_loadu_ps(bone), w);
+		__m128 c1 = _mm_mul_ps(_mm_loadu_ps(bone + 4), w);
+		__m128 c2 = _mm_mul_ps(_mm_loadu_ps(bone + 8), w);
+		__m128 c3 = _mm_mul_ps(_mm_loadu_ps(bone + 12), w);
+
+		for(int k = 1; k < NUM_WEIGHTS_PER_VERTEX; k++)
+		{
+			if(weight.weights[k] == 0.0f)
+				continue;
+
+			bone = &boneTransforms[weight.boneIDs[k]][0][0];
+			w = _mm_set1_ps(weight.weights[k]);
+
+			c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(bone), w));
+			c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(bone + 4), w));
+			c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(bone + 8), w));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(bone + 12), w));
+		}
+
+		const glm::vec3& p = bindPositions[vertID];
+		const glm::vec3& n = bindNormals[vertID];
+
+		__m128 position = _mm_mul_ps(c0, _mm_set1_ps(p.x));
+		position = _mm_add_ps(position, _mm_mul_ps(c1, _mm_set1_ps(p.y)));
+		position = _mm_add_ps(position, _mm_mul_ps(c2, _mm_set1_ps(p.z)));
+		position = _mm_add_ps(position, c3);
+
+		__m128 normal = _mm_mul_ps(c0, _mm_set1_ps(n.x));
+		normal = _mm_add_ps(normal, _mm_mul_ps(c1, _mm_set1_ps(n.y)));
+		normal = _mm_add_ps(normal, _mm_mul_ps(c2, _mm_set1_ps(n.z)));
+
+		//The w lane of the normal is 0, so a full dot product is its length squared
+		__m128 lengthSquared = _mm_mul_ps(normal, normal);
+		lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(2, 3, 0, 1)));
+		lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(1, 0, 3, 2)));
+		//Masked so a zero length normal stays zero rather than 0/0
+		normal = _mm_and_ps(_mm_div_ps(normal, _mm_sqrt_ps(lengthSquared)), _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()));
+
+		float out[8];
+		_mm_storeu_ps(out, position);
+		_mm_storeu_ps(out + 4, normal);
+
+		positions[vertID] = glm::vec3(out[0], out[1], out[2]);
+		normals[vertID] = glm::vec3(out[4], out[5], out[6]);
+	}
+}
+#else
+void CpuSkinnedMesh::SkinSSE(const glm::mat4* boneTransforms)
+{
+	SkinScalar(boneTransforms);
+}
+#endif
+
+void CpuSkinnedMesh::SkinAll(const std::vector<CpuSkinnedMesh*>& meshes, const std::vector<const glm::mat4*>& boneTransforms)
+{
+	if(JobSystem::Instance)
+	{
+		JobSystem::Instance->ParallelFor(meshes.size(), [&meshes, &boneTransforms](int i) { meshes[i]->Skin(boneTransforms[i]); });
+	}
+	else
+	{
+		for(int i = 0; i < meshes.size(); i++)
+			meshes[i]->Skin(boneTransforms[i]);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "AssetCache.h"
+
+//Skins a mesh's positions on the CPU the same way Shaders/skinned.vs does on the GPU, for machines without one
+//and for anything that needs the skinned vertices back (collision, validation). Normals are skinned too, which the
+//shader doesn't do, it passes them through as they are. Needs no GL context, so it works straight from a MeshData
+//loaded through AssetCache.
+class CpuSkinnedMesh
+{
+	private:
+
+		std::vector<glm::vec3> bindPositions;
+		std::vector<glm::vec3> bindNormals;
+		std::vector<VertexWeight> vertexWeights;
+
+		int numBones;
+
+		void SkinScalar(const glm::mat4* boneTransforms);
+		void SkinSSE(const glm::mat4* boneTransforms);
+
+	public:
+
+		//The skinned vertices, in the same space the vertex shader gets them in before the mvp matrix
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> normals;
+
+		CpuSkinnedMesh() : numBones(0) {}
+
+		//Copies what it needs out of the mesh, fails if it isn't skinned or its weights point past its bones
+		bool Init(const MeshData& mesh);
+
+		//boneTransforms needs an entry per bone, as from Skeleton::GetFinalTransforms.
+		//Uses SSE when the CPU has it, see SkinningKernel.h. That's vectorised across each vertex's matrix, not across vertices.
+		void Skin(const glm::mat4* boneTransforms);
+
+		//Plain glm, a line for line copy of the shader to check the fast path against
+		void SkinReference(const glm::mat4* boneTransforms, std::vector<glm::vec3>& referencePositions, std::vector<glm::vec3>& referenceNormals);
+
+		//Largest difference between Skin and SkinReference for the given pose, positions and normals together.
+		//FLT_MAX if either has a NaN in it.
+		float Verify(const glm::mat4* boneTransforms);
+
+		int GetNumVertices() { return bindPositions.size(); }
+		int GetNumBones() { return numBones; }
+
+		//Skins meshes[i] with boneTransforms[i], spread over the job system when there is one
+		static void SkinAll(const std::vector<CpuSkinnedMesh*>& meshes, const std::vector<const glm::mat4*>& boneTransforms);
+};
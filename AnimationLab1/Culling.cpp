@@ -0,0 +1,162 @@
+#include "Culling.h"
+#include "SkinningKernel.h"
+
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CULLING_SSE
+
+#include <emmintrin.h>
+
+#ifdef _MSC_VER
+#define TARGET_SSE
+#else
+#define TARGET_SSE __attribute__((target("sse2")))
+#endif
+
+#endif
+
+BoundingBox TransformBox(const BoundingBox& box, const glm::mat4& matrix)
+{
+	if(box.IsEmpty())
+		return box;
+
+	//The centre moves as a point, each axis of the new half extent is how far the old one reaches along it
+	glm::vec3 center = glm::vec3(matrix * glm::vec4(box.GetCenter(), 1.0f));
+	glm::vec3 halfExtent = box.GetHalfExtent();
+	glm::vec3 newHalfExtent(0.0f);
+
+	for(int column = 0; column < 3; column++)
+		newHalfExtent += glm::abs(glm::vec3(matrix[column])) * halfExtent[column];
+
+	BoundingBox transformed;
+	transformed.min = center - newHalfExtent;
+	transformed.max = center + newHalfExtent;
+
+	return transformed;
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection)
+{
+	//The rows of the matrix, each plane is the last row plus or minus one of the others (Gribb and Hartmann)
+	glm::vec4 rows[4];
+	for(int row = 0; row < 4; row++)
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[3] + rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for(int i = 0; i < 6; i++)
+		frustum.planes[i] /= glm::length(glm::vec3(frustum.planes[i]));
+
+	return frustum;
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+	for(int i = 0; i < 6; i++)
+	{
+		if(glm::dot(glm::vec3(planes[i]), sphere.center) + planes[i].w < -sphere.radius)
+			return false;
+	}
+
+	return true;
+}
+
+void CullingBatch::Clear()
+{
+	x.clear();
+	y.clear();
+	z.clear();
+	radius.clear();
+	visible.clear();
+	numVisible = 0;
+}
+
+int CullingBatch::Add(const BoundingSphere& sphere)
+{
+	x.push_back(sphere.center.x);
+	y.push_back(sphere.center.y);
+	z.push_back(sphere.center.z);
+	radius.push_back(sphere.radius);
+	visible.push_back(1);
+
+	return visible.size() - 1;
+}
+
+void CullingBatch::Cull(const Frustum& frustum)
+{
+	//From scratch every time, so culling again without a Clear doesn't count anything twice
+	numVisible = 0;
+	std::fill(visible.begin(), visible.end(), 0);
+
+#ifdef CULLING_SSE
+	if(GetSimdLevel() >= SimdSSE)
+	{
+		CullSSE(frustum);
+		return;
+	}
+#endif
+
+	CullScalar(frustum, 0);
+}
+
+void CullingBatch::CullScalar(const Frustum& frustum, int first)
+{
+	for(int i = first; i < visible.size(); i++)
+	{
+		visible[i] = frustum.Intersects(BoundingSphere(glm::vec3(x[i], y[i], z[i]), radius[i])) ? 1 : 0;
+		numVisible += visible[i];
+	}
+}
+
+#ifdef CULLING_SSE
+//Four spheres a plane at a time, a sphere is out once it's wholly behind any plane
+TARGET_SSE void CullingBatch::CullSSE(const Frustum& frustum)
+{
+	int count = visible.size();
+	int batched = count & ~3;
+
+	for(int i = 0; i < batched; i += 4)
+	{
+		__m128 sx = _mm_loadu_ps(&x[i]);
+		__m128 sy = _mm_loadu_ps(&y[i]);
+		__m128 sz = _mm_loadu_ps(&z[i]);
+		__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for(int p = 0; p < 6; p++)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+
+			//Summed in the order Intersects sums them, so the two agree on spheres touching a plane
+			__m128 distance = _mm_add_ps(_mm_mul_ps(sx, _mm_set1_ps(plane.x)), _mm_mul_ps(sy, _mm_set1_ps(plane.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(sz, _mm_set1_ps(plane.z)));
+			distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+
+		for(int lane = 0; lane < 4; lane++)
+		{
+			visible[i + lane] = (mask >> lane) & 1;
+			numVisible += visible[i + lane];
+		}
+	}
+
+	CullScalar(frustum, batched);
+}
+#else
+void CullingBatch::CullSSE(const Frustum& frustum)
+{
+	CullScalar(frustum, 0);
+}
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <float.h>
+#include <vector>
+
+//Axis aligned, empty until something is added
+struct BoundingBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	BoundingBox() : min(FLT_MAX), max(-FLT_MAX) {}
+
+	void Add(const glm::vec3& point) { min = glm::min(min, point); max = glm::max(max, point); }
+	void Add(const BoundingBox& box) { min = glm::min(min, box.min); max = glm::max(max, box.max); }
+
+	bool IsEmpty() const { return min.x > max.x; }
+	glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+	glm::vec3 GetHalfExtent() const { return (max - min) * 0.5f; }
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+
+	BoundingSphere() : center(0.0f), radius(0.0f) {}
+	BoundingSphere(const glm::vec3& center, float radius) : center(center), radius(radius) {}
+
+	//Around the box, not the smallest sphere around whatever is in it
+	explicit BoundingSphere(const BoundingBox& box) : center(box.GetCenter()), radius(glm::length(box.GetHalfExtent())) {}
+};
+
+//The box around box once it's been through matrix, which can include rotation and scale
+BoundingBox TransformBox(const BoundingBox& box, const glm::mat4& matrix);
+
+//Six planes facing into the view volume, a point p is inside all of them when dot(plane.xyz, p) + plane.w >= 0
+struct Frustum
+{
+	glm::vec4 planes[6]; //Left, right, bottom, top, near, far
+
+	//From projection * view, giving world space planes, normalised so distances to them are true distances
+	static Frustum FromMatrix(const glm::mat4& viewProjection);
+
+	bool Intersects(const BoundingSphere& sphere) const;
+};
+
+//Spheres kept as a struct of arrays, so Cull can test four at once against each plane with SSE
+class CullingBatch
+{
+	private:
+
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> radius;
+
+		std::vector<unsigned char> visible;
+		int numVisible;
+
+		void CullScalar(const Frustum& frustum, int first);
+		void CullSSE(const Frustum& frustum);
+
+	public:
+
+		CullingBatch() : numVisible(0) {}
+
+		//Empties the batch, keeping the memory for the next frame
+		void Clear();
+
+		//Returns the sphere's index, for IsVisible
+		int Add(const BoundingSphere& sphere);
+
+		//Uses SSE when the CPU has it, see SkinningKernel.h
+		void Cull(const Frustum& frustum);
+
+		bool IsVisible(int index) const { return visible[index] != 0; }
+		int GetNumVisible() const { return numVisible; }
+		int GetNumCulled() const { return visible.size() - numVisible; }
+		int GetSize() const { return visible.size(); }
+};
@@ -0,0 +1,54 @@
+#include "FixedTimestep.h"
+
+#define FRAME_STATS_SMOOTHING 0.05 //How much each frame moves the averages
+
+FixedTimestep::FixedTimestep(double stepTime, int maxStepsPerFrame)
+{
+	this->stepTime = stepTime;
+	this->maxStepsPerFrame = maxStepsPerFrame;
+
+	started = false;
+	lastTime = 0.0;
+	accumulator = 0.0;
+}
+
+double FixedTimestep::Advance(const std::function<void(double stepTime)>& step)
+{
+	//The first frame only starts the clock, otherwise all the loading would be owed
+	double now = clock.ElapsedMilliseconds();
+	double frameTime = started ? now - lastTime : 0.0;
+
+	started = true;
+	lastTime = now;
+
+	accumulator += frameTime;
+
+	Timer simulationTimer;
+	int steps = 0;
+
+	while(accumulator >= stepTime && steps < maxStepsPerFrame)
+	{
+		step(stepTime);
+
+		accumulator -= stepTime;
+		steps++;
+	}
+
+	//Still behind after the budget, let the whole steps go and keep the fraction to interpolate with
+	if(accumulator >= stepTime)
+	{
+		int behind = int(accumulator / stepTime);
+
+		stats.droppedSteps += behind;
+		accumulator -= behind * stepTime;
+	}
+
+	stats.frameTime = frameTime;
+	stats.simulationTime = simulationTimer.ElapsedMilliseconds();
+	stats.steps = steps;
+
+	stats.averageFrameTime += (stats.frameTime - stats.averageFrameTime) * FRAME_STATS_SMOOTHING;
+	stats.averageSimulationTime += (stats.simulationTime - stats.averageSimulationTime) * FRAME_STATS_SMOOTHING;
+
+	return frameTime;
+}
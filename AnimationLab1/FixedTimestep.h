@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+
+#include "Timer.h"
+
+//How the frames are going, times in ms
+struct FrameStats
+{
+	double frameTime; //Wall clock time since the frame before
+	double averageFrameTime;
+	double simulationTime; //Spent running steps this frame
+	double averageSimulationTime;
+	int steps; //Run this frame
+	int droppedSteps; //Steps' worth of time thrown away since the start, because frames fell too far behind
+
+	FrameStats() : frameTime(0), averageFrameTime(0), simulationTime(0), averageSimulationTime(0), steps(0), droppedSteps(0) {}
+};
+
+//Runs the simulation at a fixed rate whatever rate frames are drawn at. Each frame's time is banked and spent a step
+//at a time, and what's left over says how far between the last two steps the frame should be drawn.
+class FixedTimestep
+{
+	private:
+
+		Timer clock;
+		bool started;
+		double lastTime;
+		double accumulator;
+
+		FrameStats stats;
+
+	public:
+
+		double stepTime; //ms
+		int maxStepsPerFrame; //Catch up budget, time owed past it is dropped so a slow frame can't make the next one slower still
+
+		FixedTimestep(double stepTime = 1000.0 / 60.0, int maxStepsPerFrame = 4);
+
+		//Call once a frame. Runs step as many times as the time since the last frame pays for, returns the frame time.
+		double Advance(const std::function<void(double stepTime)>& step);
+
+		//0 to 1, how far the frame is from the last step towards the next one
+		float GetInterpolation() { return float(accumulator / stepTime); }
+
+		const FrameStats& GetStats() { return stats; }
+};
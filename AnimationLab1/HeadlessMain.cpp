@@ -0,0 +1,37 @@
+#include "Simulation.h"
+#include "AssetCache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//The game's simulation on its own, for machines with no display, GL or Windows (see CMakeLists.txt). The same as
+//running the game with -headless, e.g.
+//    AnimationHeadless 10000 -cpuskinning
+//runs 10000 steps and skins the characters on the CPU as it goes. With no arguments it runs 3600 steps, a minute of game.
+//Run it from the folder with Models, Animations and Levels in. Builds without assimp can only read baked assets,
+//so bake them once with a build that has it: -bake only rebakes what changed, -bake -force rebakes everything.
+
+int main(int argc, char** argv)
+{
+	if(argc > 1 && strcmp(argv[1], "-bake") == 0)
+		return AssetCache::BakeAll(argc > 2 && strcmp(argv[2], "-force") == 0) == 0 ? 0 : 1;
+
+	int numFrames = 3600;
+	bool cpuSkinning = false;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-cpuskinning") == 0)
+			cpuSkinning = true;
+		else if(atoi(argv[i]) > 0)
+			numFrames = atoi(argv[i]);
+		else
+		{
+			fprintf(stderr, "Usage: %s [frames] [-cpuskinning] or %s -bake [-force]\n", argv[0], argv[0]);
+			return 1;
+		}
+	}
+
+	return runHeadless(numFrames, cpuSkinning);
+}
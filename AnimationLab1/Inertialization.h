@@ -0,0 +1,120 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <math.h>
+
+//Inertialization switches to the new animation straight away and hides the pop by adding the difference between
+//the old pose and the new one, decayed to nothing over the blend time, so only the new animation is ever sampled.
+//The decay is the quintic from Bollo's "Inertialization: High-Performance Animation Transitions in Gears of War",
+//it starts at the offset and velocity the old animation left off with and lands at zero with no velocity or acceleration.
+struct InertialDecay
+{
+	float x0, v0, a0;
+	float A, B, C;
+	float duration;
+
+	InertialDecay() : x0(0), v0(0), a0(0), A(0), B(0), C(0), duration(0) {}
+
+	//offset is where we are now, previousOffset where we were deltaTime seconds ago, both measured from the new pose
+	void Init(float offset, float previousOffset, float deltaTime, float blendDuration)
+	{
+		x0 = offset;
+		v0 = deltaTime > 0.0f ? (offset - previousOffset) / deltaTime : 0.0f;
+		duration = blendDuration;
+
+		if(x0 <= 0.0f || duration <= 0.0f)
+		{
+			x0 = 0.0f;
+			duration = 0.0f;
+			return;
+		}
+
+		//Heading away from the new pose would overshoot it, and heading towards it fast enough gets there early
+		if(v0 > 0.0f)
+			v0 = 0.0f;
+		else if(v0 < 0.0f)
+			duration = glm::min(duration, -5.0f * x0 / v0);
+
+		float t1 = duration;
+		float t1Squared = t1 * t1;
+
+		a0 = glm::max((-8.0f * v0 * t1 - 20.0f * x0) / t1Squared, 0.0f);
+
+		A = -(a0 * t1Squared + 6.0f * v0 * t1 + 12.0f * x0) / (2.0f * t1Squared * t1Squared * t1);
+		B = (3.0f * a0 * t1Squared + 16.0f * v0 * t1 + 30.0f * x0) / (2.0f * t1Squared * t1Squared);
+		C = -(3.0f * a0 * t1Squared + 12.0f * v0 * t1 + 20.0f * x0) / (2.0f * t1Squared * t1);
+	}
+
+	float Evaluate(float t) const
+	{
+		if(t >= duration)
+			return 0.0f;
+
+		return (((((A * t + B) * t + C) * t + 0.5f * a0) * t + v0) * t + x0);
+	}
+};
+
+//What one bone still has to lose, the offsets are along a fixed axis so each channel decays as a single number
+struct InertialBoneOffset
+{
+	glm::vec3 translationAxis;
+	InertialDecay translation;
+
+	glm::vec3 rotationAxis;
+	InertialDecay rotation; //Radians
+};
+
+//Angle in radians and unit axis of a rotation, taking the short way round
+inline float ToAxisAngle(glm::quat q, glm::vec3& axis)
+{
+	if(q.w < 0.0f)
+		q = -q;
+
+	float sinHalfAngle = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z);
+
+	if(sinHalfAngle < 1e-6f)
+	{
+		axis = glm::vec3(1, 0, 0);
+		return 0.0f;
+	}
+
+	axis = glm::vec3(q.x, q.y, q.z) / sinHalfAngle;
+	return 2.0f * atan2f(sinHalfAngle, q.w);
+}
+
+inline glm::quat FromAxisAngle(const glm::vec3& axis, float angle)
+{
+	float s = sinf(angle * 0.5f);
+	return glm::quat(cosf(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+}
+
+//Measures how far the outgoing pose is from the incoming one, and how fast it was moving, and sets up the decays
+inline void BeginInertialization(InertialBoneOffset& offset,
+	const glm::vec3& targetTranslation, const glm::quat& targetOrientation,
+	const glm::vec3& lastTranslation, const glm::quat& lastOrientation,
+	const glm::vec3& olderTranslation, const glm::quat& olderOrientation,
+	float deltaTime, float blendDuration)
+{
+	glm::vec3 translationOffset = lastTranslation - targetTranslation;
+	float translationLength = glm::length(translationOffset);
+
+	offset.translationAxis = translationLength > 1e-6f ? translationOffset / translationLength : glm::vec3(1, 0, 0);
+	offset.translation.Init(translationLength, glm::dot(olderTranslation - targetTranslation, offset.translationAxis), deltaTime, blendDuration);
+
+	glm::quat inverseTarget = glm::inverse(targetOrientation);
+	float angle = ToAxisAngle(lastOrientation * inverseTarget, offset.rotationAxis);
+
+	//Only the part of the older offset around the same axis counts towards the velocity
+	glm::vec3 olderAxis;
+	float olderAngle = ToAxisAngle(olderOrientation * inverseTarget, olderAxis);
+
+	offset.rotation.Init(angle, olderAngle * glm::dot(olderAxis, offset.rotationAxis), deltaTime, blendDuration);
+}
+
+inline void ApplyInertialization(const InertialBoneOffset& offset, float time, glm::vec3& translation, glm::quat& orientation)
+{
+	translation += offset.translationAxis * offset.translation.Evaluate(time);
+	orientation = FromAxisAngle(offset.rotationAxis, offset.rotation.Evaluate(time)) * orientation;
+}
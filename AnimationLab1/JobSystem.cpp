@@ -0,0 +1,137 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+JobSystem* JobSystem::Instance;
+
+static THREAD_LOCAL bool insideJob = false;
+
+JobSystem::JobSystem(int numWorkers)
+{
+	job = 0;
+	count = 0;
+	grain = 1;
+	next = 0;
+
+	busyWorkers = 0;
+	generation = 0;
+	quit = false;
+
+	if(numWorkers < 0)
+		numWorkers = GetHardwareThreads() - 1;
+
+	for(int i = 0; i < numWorkers; i++)
+		workers.push_back(std::thread(&JobSystem::WorkerLoop, this));
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+
+	wake.notify_all();
+
+	for(int i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	if(Instance == this)
+		Instance = 0;
+}
+
+int JobSystem::GetHardwareThreads()
+{
+	int threads = std::thread::hardware_concurrency();
+	return threads > 0 ? threads : 1; //0 means it couldn't tell
+}
+
+void JobSystem::ParallelFor(int count, const std::function<void(int)>& job, int grain)
+{
+	if(count <= 0)
+		return;
+
+	grain = std::max(grain, 1);
+
+	//Not worth waking anyone, or we're already inside a loop and the workers are busy with it
+	if(workers.empty() || count <= grain || insideJob)
+	{
+		for(int i = 0; i < count; i++)
+			job(i);
+
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		this->job = &job;
+		this->count = count;
+		this->grain = grain;
+		next = 0;
+
+		busyWorkers = workers.size();
+		generation++;
+	}
+
+	wake.notify_all();
+
+	RunChunks();
+
+	//Every worker has to check in, even ones that found nothing left, so none of them is still looking at job when we return
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return busyWorkers == 0; });
+
+	this->job = 0;
+}
+
+void JobSystem::RunChunks()
+{
+	insideJob = true;
+
+	while(true)
+	{
+		int start = next.fetch_add(grain);
+
+		if(start >= count)
+			break;
+
+		int end = std::min(start + grain, count);
+
+		for(int i = start; i < end; i++)
+			(*job)(i);
+	}
+
+	insideJob = false;
+}
+
+void JobSystem::WorkerLoop()
+{
+	unsigned int seen = 0;
+
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, seen] { return quit || generation != seen; });
+
+			if(quit)
+				return;
+
+			seen = generation;
+		}
+
+		RunChunks();
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(--busyWorkers == 0)
+			finished.notify_one();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+//A fixed pool of worker threads for data parallel loops. ParallelFor hands out indices in chunks of grain
+//from a shared counter, so threads that finish early keep taking work from the ones that haven't.
+//The calling thread works too, and a ParallelFor started from inside a job runs serially on that thread.
+class JobSystem
+{
+	private:
+
+		std::vector<std::thread> workers;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable finished;
+
+		//The loop currently being run
+		const std::function<void(int)>* job;
+		int count;
+		int grain;
+		std::atomic<int> next;
+
+		int busyWorkers;
+		unsigned int generation; //Bumped for every loop so workers know there's something new
+		bool quit;
+
+		void WorkerLoop();
+		void RunChunks();
+
+	public:
+
+		static JobSystem* Instance;
+
+		//numWorkers < 0 picks one per hardware thread, less the one calling ParallelFor
+		JobSystem(int numWorkers = -1);
+		~JobSystem();
+
+		void Init() { Instance = this; }
+
+		void ParallelFor(int count, const std::function<void(int)>& job, int grain = 1);
+
+		int GetNumThreads() { return workers.size() + 1; }
+
+		static int GetHardwareThreads();
+};
@@ -1,5 +1,7 @@
 #include "LevelEditor.h"
 
+#include <GL/freeglut.h>
+
 const glm::vec3 LevelEditor::rotationAxes[3] = { glm::vec3(1,0,0), glm::vec3(0,1,0), glm::vec3(0,0,1) };
 
 LevelEditor::LevelEditor(vector<Model*> *objectList)
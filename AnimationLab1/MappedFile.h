@@ -0,0 +1,123 @@
+#pragma once
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <stddef.h>
+
+//Read only view of a whole file, the OS pages it in as it is read instead of us copying it through a stream
+class MappedFile
+{
+	private:
+
+		const char* data;
+		size_t size;
+
+#ifdef _WIN32
+		HANDLE file;
+		HANDLE mapping;
+#else
+		int file;
+#endif
+
+	public:
+
+		MappedFile()
+		{
+			data = 0;
+			size = 0;
+
+#ifdef _WIN32
+			file = INVALID_HANDLE_VALUE;
+			mapping = 0;
+#else
+			file = -1;
+#endif
+		}
+
+		~MappedFile()
+		{
+			Close();
+		}
+
+		bool Open(const char* fileName)
+		{
+			Close();
+
+#ifdef _WIN32
+			file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+
+			LARGE_INTEGER fileSize;
+			if(file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+			{
+				Close();
+				return false;
+			}
+
+			mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+			if(mapping)
+				data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+			size = (size_t)fileSize.QuadPart;
+#else
+			file = open(fileName, O_RDONLY);
+
+			struct stat info;
+			if(file < 0 || fstat(file, &info) != 0 || info.st_size == 0)
+			{
+				Close();
+				return false;
+			}
+
+			void* view = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if(view != MAP_FAILED)
+				data = (const char*)view;
+
+			size = (size_t)info.st_size;
+#endif
+
+			if(!data)
+			{
+				Close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void Close()
+		{
+#ifdef _WIN32
+			if(data)
+				UnmapViewOfFile(data);
+			if(mapping)
+				CloseHandle(mapping);
+			if(file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+
+			file = INVALID_HANDLE_VALUE;
+			mapping = 0;
+#else
+			if(data)
+				munmap((void*)data, size);
+			if(file >= 0)
+				close(file);
+
+			file = -1;
+#endif
+
+			data = 0;
+			size = 0;
+		}
+
+		const char* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+};
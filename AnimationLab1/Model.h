@@ -1,14 +1,8 @@
 #ifndef _OBJ3D_H                // Prevent multiple definitions if this 
 #define _OBJ3D_H                // file is included in more than one place
 
-#include <GL/glew.h>
-#include <GL/freeglut.h>
-
 #include "Common.h"
 
-#include <assimp/cimport.h> // C importer
-#include <assimp/scene.h> // collects data
-#include <assimp/postprocess.h> // various extra operations
 #include <assert.h>
 
 #include <string> 
@@ -20,10 +14,12 @@
 #include <vector>
 
 #include "Bone.h"
-#include "helper.h"
+#include "Helper.h"
 #include "Skeleton.h"
-
-#include "Magick++.h"
+#include "AssetCache.h"
+#include "CpuSkinning.h"
+#include "RenderQueue.h"
+#include "Culling.h"
 
 using namespace std;
 
@@ -66,30 +62,42 @@ struct MeshEntry {
     unsigned int BaseVertex;
     unsigned int BaseIndex;
 	unsigned int TextureIndex; 
+
+	BoundingBox Bounds; //Mesh space, around the bind pose
 };
 
+//GL names are kept as plain integers, as in RenderQueue.h, so models can be loaded and simulated in builds without GL.
+//Everything that needs GL is in ModelGL.cpp.
 class Model
 {
 	private:
 
 		std::string fileName;
 
-		GLuint vao;
+		unsigned int vao;
 		vector<int> indices;
 
-		vector<GLuint> textures;
+		vector<unsigned int> textures;
 		
-		GLuint shaderProgramID;
+		unsigned int shaderProgramID;
 
 		int vertexCount;
 
 		Skeleton* skeleton;
 		bool hasSkeleton;
 
+		CpuSkinnedMesh* cpuSkinnedMesh; //Only there once EnableCpuSkinning has been called
+
+		BoundingBox bounds; //Mesh space, around all the mesh entries in the bind pose
+
 		bool wireframe;
 		float dieTimer;
 		float dieWaitTime;
 
+		//In ModelGL.cpp
+		void CreateVertexArray();
+		bool Upload(const MeshData& mesh);
+
 	public:
 		
 		bool serialise;
@@ -98,15 +106,19 @@ class Model
 
 		glm::mat4 globalInverseTransform;
 
-		Model(glm::vec3 position, glm::mat4 orientation, glm::vec3 scale, const char* file_name, GLuint shaderProgramID, bool serialise = true, bool wireframe = false);
+		static bool Headless; //Load meshes and skeletons without touching GL, for running the game with no window
+
+		Model(glm::vec3 position, glm::mat4 orientation, glm::vec3 scale, const char* file_name, unsigned int shaderProgramID, bool serialise = true, bool wireframe = false);
 		~Model();
 
 		WorldProperties worldProperties;
+		WorldProperties previousWorldProperties; //As of the simulation step before, frames are drawn in between
 		vector<MeshEntry> meshEntries;
 
 		bool Load(const char* file_name);
 		
-		void Render(GLuint shader);
+		//A draw per mesh entry, matrix is the mvp from queue.AddMatrix
+		void QueueDraws(RenderQueue& queue, int matrix, int paletteOffset = -1);
 
 		void Update(double deltaTime)
 		{
@@ -131,18 +143,30 @@ class Model
 			}
 		}
 
-		GLuint LoadTexture(const char* fileName);
-		void LoadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName);
+		unsigned int LoadTexture(const char* fileName); //In ModelGL.cpp
+
+		//Keeps a copy of the mesh on the CPU and skins it with the skeleton's current pose in UpdateCpuSkinning,
+		//for when the skinned vertices are needed outside the shader
+		bool EnableCpuSkinning();
+		void UpdateCpuSkinning() { if(cpuSkinnedMesh) cpuSkinnedMesh->Skin(skeleton->GetFinalTransforms()); }
 
 		void LoadAnimation(const char* file_name) { if (hasSkeleton) skeleton->LoadAnimation(file_name); else std::cout << "\nCan't load an animation, there's no skeleton!\n"; }
 
 		//Getters
-		GLuint GetVAO() { return vao; }
-		GLuint GetShaderProgramID() { return shaderProgramID; }
+		unsigned int GetVAO() { return vao; }
+		unsigned int GetShaderProgramID() { return shaderProgramID; }
 		int GetVertexCount() { return vertexCount; }
 		Skeleton* GetSkeleton() { return skeleton; }
 		bool HasSkeleton() { return hasSkeleton; }
+		CpuSkinnedMesh* GetCpuSkinnedMesh() { return cpuSkinnedMesh; }
 		vector<int> GetIndices() { return indices; }
+		const BoundingBox& GetBounds() { return bounds; }
+
+		//Mesh space like GetBounds, but following the pose for skinned models
+		BoundingBox GetPosedBounds() { return hasSkeleton ? skeleton->GetSkinnedBounds() : bounds; }
+
+		//World space, around the model as it'll be drawn
+		BoundingBox GetWorldBounds(float interpolation) { return TransformBox(GetPosedBounds(), GetModelMatrix(interpolation)); }
 
 		std::string GetFileName() { return fileName; }
 		
@@ -155,6 +179,23 @@ class Model
 				* globalInverseTransform;
 		}		
 
+		//Call before each simulation step
+		void SaveWorldProperties() { previousWorldProperties = worldProperties; }
+
+		//The model matrix interpolation of the way from the last step to this one
+		glm::mat4 GetModelMatrix(float interpolation)
+		{
+			glm::quat orientation = glm::slerp(glm::toQuat(previousWorldProperties.orientation), glm::toQuat(worldProperties.orientation), interpolation);
+
+			return 
+				glm::translate(glm::mat4(1.0f), glm::mix(previousWorldProperties.translation, worldProperties.translation, interpolation)) 
+				* glm::toMat4(orientation)
+				* glm::scale(glm::mat4(1.0f), glm::mix(previousWorldProperties.scale, worldProperties.scale, interpolation))
+				* globalInverseTransform;
+		}
+
+		glm::vec3 GetTranslation(float interpolation) { return glm::mix(previousWorldProperties.translation, worldProperties.translation, interpolation); }
+
 		glm::vec3 GetEulerAngles()
 		{
 			return glm::eulerAngles(glm::toQuat(worldProperties.orientation));
@@ -166,7 +207,7 @@ class Model
 		}
 
 		//Setters
-		void SetShaderProgramID(GLuint p_shaderProgramID) { shaderProgramID = p_shaderProgramID; }
+		void SetShaderProgramID(unsigned int p_shaderProgramID) { shaderProgramID = p_shaderProgramID; }
 
 };
 
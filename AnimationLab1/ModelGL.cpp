@@ -0,0 +1,115 @@
+#include "Model.h"
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include <stddef.h>
+
+#include "Magick++.h"
+
+//The half of Model that needs GL, left out of builds without it along with the rest of the drawing
+
+void Model::CreateVertexArray()
+{
+	glGenVertexArrays (1, &vao);
+}
+
+bool Model::Upload(const MeshData& mesh)
+{
+	//2. BUFFER THE DATA
+	glBindVertexArray (vao);
+	GLuint *buffers = new GLuint [NUM_VBs];
+
+	glGenBuffers(NUM_VBs, buffers);
+
+	if(mesh.positions.size() > 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[POS_VB]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(mesh.positions[0]) * mesh.positions.size(), &mesh.positions[0], GL_STATIC_DRAW);
+   
+		glEnableVertexAttribArray(POS_VB);
+		glVertexAttribPointer(POS_VB, 3, GL_FLOAT, GL_FALSE, 0, 0);  
+	}
+
+	if(mesh.normals.size() > 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[NORMAL_VB]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(mesh.normals[0]) * mesh.normals.size(), &mesh.normals[0], GL_STATIC_DRAW);
+   
+		glEnableVertexAttribArray(NORMAL_VB);
+		glVertexAttribPointer(NORMAL_VB, 3, GL_FLOAT, GL_FALSE, 0, 0);  
+	}
+	
+	if (mesh.texcoords.size() > 0) 
+	{
+		glBindBuffer (GL_ARRAY_BUFFER, buffers[TEXCOORD_VB]);
+		glBufferData (GL_ARRAY_BUFFER, sizeof(mesh.texcoords[0]) * mesh.texcoords.size(), &mesh.texcoords[0], GL_STATIC_DRAW);
+		
+		glVertexAttribPointer (TEXCOORD_VB, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+		glEnableVertexAttribArray (TEXCOORD_VB);
+	}
+
+	if (indices.size() > 0)
+	{
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[INDEX_VB]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indices.size(), &indices[0], GL_STATIC_DRAW);
+	}
+
+	if (mesh.bones.size() > 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffers[WEIGHT_VB]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(mesh.vertexWeights[0]) * mesh.vertexWeights.size(), &mesh.vertexWeights[0], GL_STATIC_DRAW);
+		
+		glEnableVertexAttribArray(3);
+		glVertexAttribIPointer(3, 4, GL_INT, sizeof(VertexWeight), (const GLvoid*)0);
+
+		glEnableVertexAttribArray(4);    
+		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(VertexWeight), (const GLvoid*)offsetof(VertexWeight, weights)); 
+	}
+
+	printf ("\nMesh loaded.\n");
+
+	delete[] buffers;
+	
+	return true;
+}
+
+unsigned int Model::LoadTexture(const char* fileName) 
+{		
+	Magick::Blob blob;
+	Magick::Image* image; 
+
+	string stringFileName(fileName);
+	string fullPath = "Textures/" + stringFileName;
+
+	try {
+		image = new Magick::Image(fullPath.c_str());
+		image->write(&blob, "RGBA");
+	}
+	catch (Magick::Error& Error) {
+		std::cout << "Error loading texture '" << fullPath << "': " << Error.what() << std::endl;
+
+		delete image;
+		return false;
+	}
+
+	GLuint textureID;
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+			
+	//Load the image data in to the texture
+	glTexImage2D(GL_TEXTURE_2D, 0/*LOD*/, GL_RGBA, image->columns(), image->rows(), 0/*BORDER*/, GL_RGBA, GL_UNSIGNED_BYTE, blob.data());
+
+	//Parameter stuff, for magnifying texture etc.
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);   
+	glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+			
+	glBindTexture(GL_TEXTURE_2D, 0); //unbind try now without animation and see if there is that initial error
+
+	delete image;  
+	return textureID;
+}
\ No newline at end of file
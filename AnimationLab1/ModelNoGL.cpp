@@ -0,0 +1,17 @@
+#include "Model.h"
+
+//Stands in for ModelGL.cpp in builds without GL, where every model is headless and nothing is uploaded or drawn
+
+void Model::CreateVertexArray()
+{
+}
+
+bool Model::Upload(const MeshData&)
+{
+	return true;
+}
+
+unsigned int Model::LoadTexture(const char*)
+{
+	return 0;
+}
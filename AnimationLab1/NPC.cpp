@@ -1,5 +1,6 @@
 #include "NPC.h"
 #include "Keys.h"
+#include "Profiler.h"
 
 NPC::NPC(vector<Model*> &objectList, Model* model, Player* player)
 {
@@ -15,6 +16,11 @@ NPC::NPC(vector<Model*> &objectList, Model* model, Player* player)
 
 	skeleton = model->GetSkeleton();
 
+	//Too small to see from a distance, so far away LODs leave them be
+	const char* detailBones[] = { "hand.fk.L", "hand.fk.R", "toe.L", "toe.R" };
+	if(model->HasSkeleton())
+		skeleton->SetDetailBones(detailBones, ARRAY_SIZE_IN_ELEMENTS(detailBones));
+
 	state = NPCns::State::idle;
 	skeleton->AddToAnimationQueue(NPCns::State::idle);
 
@@ -45,6 +51,8 @@ void NPC::ProcessKeyboardOnce(unsigned char key, int x, int y)
 
 void NPC::Update(double deltaTime)
 {
+	PROFILE_SCOPE("NPC::Update");
+
 	if(patrolling)
 	{
 		patrol.Update(deltaTime);
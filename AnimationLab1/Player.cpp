@@ -1,6 +1,6 @@
 #include "Player.h"
 #include "Keys.h"
-#include <iomanip>
+#include "Profiler.h"
 
 Player::Player(vector<Model*> &objectList, Camera* camera, Gamepad* gamepad, Model* model)
 {
@@ -24,6 +24,11 @@ Player::Player(vector<Model*> &objectList, Camera* camera, Gamepad* gamepad, Mod
 
 	skeleton = model->GetSkeleton();
 
+	//Too small to see from a distance, so far away LODs leave them be
+	const char* detailBones[] = { "hand.fk.L", "hand.fk.R", "toe.L", "toe.R" };
+	if(model->HasSkeleton())
+		skeleton->SetDetailBones(detailBones, ARRAY_SIZE_IN_ELEMENTS(detailBones));
+
 	state = State::idle;
 	skeleton->AddToAnimationQueue(0);
 }
@@ -67,6 +72,8 @@ void Player::ProcessKeyboardOnce(unsigned char key, int x, int y)
 
 void Player::Update(double deltaTime)
 {
+	PROFILE_SCOPE("Player::Update");
+
 	if(skeleton->animationController.isIdle)
 		SetState(State::idle);
 
@@ -119,33 +126,3 @@ void Player::Move(double deltaTime, float horizontal, float vertical)
 	model->worldProperties.orientation = glm::toMat4(glm::inverse(camera->viewProperties.XZrotation));
 	model->worldProperties.orientation *= glm::toMat4(glm::quat(forwardXZ, moveDir));
 }
-
-void Player::PrintOuts(int winw, int winh)
-{
-	//PRINT PLAYER
-
-	std::stringstream ss;
-	ss << "player.pos: (" << std::fixed << std::setprecision(PRECISION) << model->worldProperties.translation.x << ", " << model->worldProperties.translation.y 
-		<< ", " << model->worldProperties.translation.z << ")";
-	drawText(20,winh-120, ss.str().c_str());
-
-	glm::vec3 euler = glm::eulerAngles(glm::toQuat(model->worldProperties.orientation));
-	ss.str(std::string()); // clear
-	ss << "player.rot: (" << std::fixed << std::setprecision(PRECISION) << euler.x << ", " << euler.y << ", " << euler.z << ")";
-	drawText(20, winh-140, ss.str().c_str());
-
-	ss.str(std::string()); // clear
-	glm::vec3 forward = model->GetForward();
-	ss << "player.forward: (" << std::fixed << std::setprecision(PRECISION) << forward.x << ", " << forward.y << ", " << forward.z << ")";
-	drawText(20, winh-160, ss.str().c_str());
-	
-	ss.str(std::string()); // clear
-	ss << "Current state: ";
-	if(state == State::idle)
-		ss << "Idle";
-	else if(state == State::run)
-		ss << "Run";
-	else if(state == State::attack)
-		ss << "One-shot";
-	drawText(20, winh-200, ss.str().c_str());
-}
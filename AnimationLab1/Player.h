@@ -3,18 +3,11 @@
 #include "Model.h"
 #include "Camera.h"
 
-#define WIN32_LEAN_AND_MEAN
-
-#include <windows.h>
-#include <Xinput.h>
-
-#pragma comment(lib, "XInput.lib")
-
-#include "Gamepad.h"
-
 #include "Common.h"
 
-#include "glm\glm.hpp"
+#include "glm/glm.hpp"
+
+class Gamepad; //Gamepad.h needs Windows, the simulation only passes it around
 
 
 enum State { idle = 0, run, attack };
@@ -54,18 +47,8 @@ class Player
 
 		void ProcessKeyboardContinuous(bool* keyStates, double deltaTime);
 		void ProcessKeyboardOnce(unsigned char key, int x, int y);
-		void ProcessMouseButton(int button, int state, int x, int y)
-		{
-			switch(button) {
-				case GLUT_LEFT_BUTTON:
-					if(state != State::run)
-					{
-						SetState(State::attack);
-					}
-					break;
-			}
-		}
-
+		//Take GLUT's buttons and draw with it, so they're in PlayerGL.cpp with the game rather than the simulation
+		void ProcessMouseButton(int button, int state, int x, int y);
 		void PrintOuts(int winw, int winh);
 
 		static bool IsAnyDirectionKeyDown(bool* keyStates)
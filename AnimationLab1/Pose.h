@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include "Common.h"
+
+//Flat, preallocated storage for the poses sampled from every active animation in a frame.
+//Translations, orientations and weights are kept in separate arrays (struct-of-arrays),
+//one layer of numBones entries per contributing animation: index = layer * numBones + boneID.
+//Sized once when the skeleton gets its animations, so sampling every frame does not touch the heap.
+struct PoseBuffer
+{
+	int numBones;
+	int maxLayers;
+
+	std::vector<glm::vec3> translations;
+	std::vector<glm::quat> orientations;
+	std::vector<float> weights;
+	std::vector<unsigned char> additive; //Additive poses hold the offset from the clip's reference pose
+
+	std::vector<int> poseCounts; //How many poses each bone has received this frame
+
+	PoseBuffer()
+	{
+		numBones = 0;
+		maxLayers = 0;
+	}
+
+	void Resize(int numBones, int maxLayers = MAX_ANIMATIONS)
+	{
+		this->numBones = numBones;
+		this->maxLayers = maxLayers;
+
+		translations.resize(numBones * maxLayers);
+		orientations.resize(numBones * maxLayers);
+		weights.resize(numBones * maxLayers);
+		additive.resize(numBones * maxLayers);
+		poseCounts.resize(numBones);
+
+		Clear();
+	}
+
+	void Clear()
+	{
+		std::fill(poseCounts.begin(), poseCounts.end(), 0);
+	}
+
+	void AddPose(int boneID, const glm::vec3& translation, const glm::quat& orientation, float weight, bool isAdditive = false)
+	{
+		int layer = poseCounts[boneID];
+
+		if(layer >= maxLayers) //More contributors than we have room for, drop it
+			return;
+
+		int index = layer * numBones + boneID;
+		translations[index] = translation;
+		orientations[index] = orientation;
+		weights[index] = weight;
+		additive[index] = isAdditive;
+
+		poseCounts[boneID]++;
+	}
+
+	int GetPoseCount(int boneID) const { return poseCounts[boneID]; }
+
+	const glm::vec3& GetTranslation(int boneID, int layer) const { return translations[layer * numBones + boneID]; }
+	const glm::quat& GetOrientation(int boneID, int layer) const { return orientations[layer * numBones + boneID]; }
+	float GetWeight(int boneID, int layer) const { return weights[layer * numBones + boneID]; }
+	bool IsAdditive(int boneID, int layer) const { return additive[layer * numBones + boneID] != 0; }
+};
@@ -0,0 +1,197 @@
+#include "Profiler.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <mutex>
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+ProfileThread* Profiler::threads[PROFILER_MAX_THREADS];
+std::atomic<int> Profiler::numThreads(0);
+
+double Profiler::frameStart = 0.0;
+std::vector<ProfileSummary> Profiler::summaries;
+
+ProfileCounter* Profiler::counters[PROFILER_MAX_COUNTERS];
+int Profiler::numCounters = 0;
+
+bool Profiler::Enabled = true;
+
+static Timer profileClock; //Every thread's times are from the same start, so they line up in the trace
+static std::mutex registerMutex;
+
+static THREAD_LOCAL ProfileThread* currentThread = 0;
+static THREAD_LOCAL bool threadRejected = false; //Past PROFILER_MAX_THREADS, this thread isn't recorded
+
+ProfileCounter::ProfileCounter(const char* name) : name(name), value(0), lastFrame(0)
+{
+	Profiler::AddCounter(this);
+}
+
+//Counters are made during static initialisation, on one thread and before any constructor in this file has necessarily run.
+//The array and count are zeroed before that, so they're safe to use, but the mutex might not be.
+void Profiler::AddCounter(ProfileCounter* counter)
+{
+	if(numCounters < PROFILER_MAX_COUNTERS)
+		counters[numCounters++] = counter;
+	else
+		fprintf(stderr, "Too many profile counters, %s won't be shown\n", counter->name);
+}
+
+double Profiler::Now()
+{
+	return profileClock.ElapsedMilliseconds();
+}
+
+double Profiler::Begin()
+{
+	GetThread();
+	return Now();
+}
+
+ProfileThread* Profiler::GetThread()
+{
+	if(currentThread || threadRejected)
+		return currentThread;
+
+	std::lock_guard<std::mutex> lock(registerMutex);
+
+	int index = numThreads.load();
+
+	if(index >= PROFILER_MAX_THREADS)
+	{
+		threadRejected = true;
+		return 0;
+	}
+
+	//Once per thread, and never freed as the events have to outlive the thread for the trace
+	ProfileThread* thread = new ProfileThread;
+	thread->written.store(0);
+	thread->index = index;
+
+	threads[index] = thread;
+	numThreads.store(index + 1); //After the slot is filled, readers only look below numThreads
+
+	currentThread = thread;
+	return thread;
+}
+
+void Profiler::Record(const char* name, double start, double end)
+{
+	ProfileThread* thread = GetThread();
+
+	if(!thread)
+		return;
+
+	unsigned int written = thread->written.load(std::memory_order_relaxed);
+
+	ProfileEvent& event = thread->events[written & (PROFILER_RING_SIZE - 1)];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+
+	thread->written.store(written + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+	double frameEnd = Now();
+
+	for(int i = 0; i < summaries.size(); i++)
+	{
+		summaries[i].time = 0.0;
+		summaries[i].calls = 0;
+	}
+
+	int count = numThreads.load();
+
+	for(int t = 0; t < count; t++)
+	{
+		ProfileThread* thread = threads[t];
+		unsigned int written = thread->written.load(std::memory_order_acquire);
+		unsigned int available = written < PROFILER_RING_SIZE ? written : PROFILER_RING_SIZE;
+
+		//Newest first, back to the start of the frame. Scopes end in order, so nothing older can still be in this frame.
+		for(unsigned int i = 0; i < available; i++)
+		{
+			const ProfileEvent& event = thread->events[(written - 1 - i) & (PROFILER_RING_SIZE - 1)];
+
+			if(event.end < frameStart)
+				break;
+
+			int s = 0;
+			while(s < summaries.size() && summaries[s].name != event.name)
+				s++;
+
+			if(s == summaries.size())
+			{
+				ProfileSummary summary;
+				summary.name = event.name;
+				summary.time = 0.0;
+				summary.averageTime = 0.0;
+				summary.calls = 0;
+				summaries.push_back(summary);
+			}
+
+			summaries[s].time += event.end - event.start;
+			summaries[s].calls++;
+		}
+	}
+
+	for(int i = 0; i < summaries.size(); i++)
+		summaries[i].averageTime = summaries[i].averageTime * 0.9 + summaries[i].time * 0.1;
+
+	for(int i = 0; i < numCounters; i++)
+		counters[i]->lastFrame = counters[i]->value.exchange(0);
+
+	frameStart = frameEnd;
+}
+
+bool Profiler::ExportChromeTrace(const char* fileName)
+{
+	FILE* file = fopen(fileName, "w");
+
+	if(!file)
+	{
+		fprintf(stderr, "Couldn't write the profile to %s\n", fileName);
+		return false;
+	}
+
+	fprintf(file, "{\"traceEvents\":[\n");
+
+	bool first = true;
+	int events = 0;
+	int count = numThreads.load();
+
+	for(int t = 0; t < count; t++)
+	{
+		ProfileThread* thread = threads[t];
+		unsigned int written = thread->written.load(std::memory_order_acquire);
+		unsigned int oldest = written > PROFILER_RING_SIZE ? written - PROFILER_RING_SIZE : 0;
+
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}",
+			first ? "" : ",\n", thread->index, thread->index);
+		first = false;
+
+		//Complete events, ts and dur in microseconds
+		for(unsigned int i = oldest; i != written; i++)
+		{
+			const ProfileEvent& event = thread->events[i & (PROFILER_RING_SIZE - 1)];
+
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+				event.name, event.start * 1000.0, (event.end - event.start) * 1000.0, thread->index);
+			events++;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	printf("Wrote %d profile events from %d threads to %s\n", events, count, fileName);
+
+	return true;
+}
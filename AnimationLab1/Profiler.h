@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#define PROFILER_RING_SIZE 16384 //Events kept per thread, a power of two
+#define PROFILER_MAX_THREADS 64
+#define PROFILER_MAX_COUNTERS 32
+
+//One timed scope, times are ms since the profiler started
+struct ProfileEvent
+{
+	const char* name;
+	double start;
+	double end;
+};
+
+//Written only by the thread it belongs to. Once it has wrapped, the oldest events are overwritten.
+struct ProfileThread
+{
+	ProfileEvent events[PROFILER_RING_SIZE];
+	std::atomic<unsigned int> written; //Events ever recorded, the next one goes in written % PROFILER_RING_SIZE
+	int index; //The tid in traces
+};
+
+//Time a name took over the last frame, summed over every thread and call
+struct ProfileSummary
+{
+	const char* name;
+	double time; //ms
+	double averageTime; //Smoothed over recent frames
+	int calls;
+};
+
+//Something counted up through a frame, e.g. GL calls made. Define them at file scope, they add themselves to the profiler.
+class ProfileCounter
+{
+	public:
+
+		const char* name;
+		std::atomic<int> value;
+		int lastFrame; //What it came to over the last frame
+
+		ProfileCounter(const char* name);
+
+		void Add(int amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+};
+
+//Scoped CPU timers. PROFILE_SCOPE("name") times the rest of the enclosing block into the calling thread's ring buffer,
+//so nothing is shared between threads while recording. Names are kept by pointer, so use string literals.
+//Build with ANIMATION_NO_PROFILER and the scopes compile to nothing.
+class Profiler
+{
+	private:
+
+		static ProfileThread* threads[PROFILER_MAX_THREADS];
+		static std::atomic<int> numThreads;
+
+		static double frameStart;
+		static std::vector<ProfileSummary> summaries;
+
+		static ProfileCounter* counters[PROFILER_MAX_COUNTERS];
+		static int numCounters;
+
+		static ProfileThread* GetThread();
+
+	public:
+
+		static bool Enabled; //Recording can be paused without rebuilding
+
+		static double Now();
+
+		//Now, after making sure the calling thread has its buffer. Registering allocates, so it's done as a scope opens rather than as it closes.
+		static double Begin();
+		static void Record(const char* name, double start, double end);
+
+		//Call once a frame, sums up the events recorded since the last call for GetSummaries and resets the counters
+		static void EndFrame();
+		static const std::vector<ProfileSummary>& GetSummaries() { return summaries; }
+
+		static void AddCounter(ProfileCounter* counter);
+		static int GetNumCounters() { return numCounters; }
+		static const ProfileCounter* GetCounter(int index) { return counters[index]; }
+
+		//Writes every event still in the ring buffers as Chrome trace JSON, open it in chrome://tracing or Perfetto.
+		//Best called while the worker threads are idle, events being written as it reads may come out torn.
+		static bool ExportChromeTrace(const char* fileName);
+};
+
+class ProfileScope
+{
+	private:
+
+		const char* name;
+		double start;
+
+	public:
+
+		ProfileScope(const char* name) : name(name) { start = Profiler::Enabled ? Profiler::Begin() : -1.0; }
+		~ProfileScope() { if(start >= 0.0) Profiler::Record(name, start, Profiler::Now()); }
+};
+
+#ifdef ANIMATION_NO_PROFILER
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNT(counter, amount)
+#else
+#define PROFILE_COUNT(counter, amount) (counter).Add(amount)
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#endif
@@ -0,0 +1,83 @@
+#include "RenderQueue.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+unsigned long long RenderQueue::MakeKey(const DrawItem& item)
+{
+	unsigned long long key = 0;
+
+	key |= (unsigned long long)(item.wireframe ? 1 : 0) << 63;
+	key |= (unsigned long long)(item.program & 0x7FFF) << 48;
+	key |= (unsigned long long)(item.vao & 0xFFFF) << 32;
+	key |= (unsigned long long)(item.texture & 0xFFFF) << 16;
+
+	return key;
+}
+
+void RenderQueue::Clear()
+{
+	items.clear();
+	matrices.clear();
+	order.clear();
+}
+
+int RenderQueue::AddMatrix(const glm::mat4& matrix)
+{
+	matrices.push_back(matrix);
+	return matrices.size() - 1;
+}
+
+void RenderQueue::Add(const DrawItem& item)
+{
+	RenderSortEntry entry;
+	entry.key = MakeKey(item);
+	entry.item = items.size();
+
+	items.push_back(item);
+	order.push_back(entry);
+}
+
+void RenderQueue::Sort()
+{
+	PROFILE_SCOPE("RenderQueue::Sort");
+
+	std::sort(order.begin(), order.end());
+}
+
+RenderStats RenderQueue::CountStateChanges(bool sorted) const
+{
+	RenderStats stats;
+
+	//What's bound, as Submit tracks it. Nothing is known before the first item.
+	unsigned int program = 0;
+	unsigned int vao = 0;
+	unsigned int texture = RENDER_ANY_TEXTURE;
+
+	for(int i = 0; i < order.size(); i++)
+	{
+		const DrawItem& item = sorted ? items[order[i].item] : items[i];
+
+		if(i == 0 || item.program != program)
+		{
+			program = item.program;
+			stats.programSwitches++;
+		}
+
+		if(i == 0 || item.vao != vao)
+		{
+			vao = item.vao;
+			stats.vaoSwitches++;
+		}
+
+		if(item.texture != RENDER_ANY_TEXTURE && item.texture != texture)
+		{
+			texture = item.texture;
+			stats.textureSwitches++;
+		}
+
+		stats.draws++;
+	}
+
+	return stats;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#define RENDER_ANY_TEXTURE 0xFFFFFFFF //For draws that don't sample a texture, whatever is bound is left bound
+
+//One draw call and the state it needs. GL names are kept as plain integers so queues can be built and sorted without GL.
+struct DrawItem
+{
+	unsigned int program;
+	unsigned int vao;
+	unsigned int texture;
+	bool wireframe;
+
+	//glDrawElementsBaseVertex over an index range, or glDrawArrays of vertexCount when numIndices is 0
+	unsigned int numIndices;
+	unsigned int baseIndex;
+	unsigned int baseVertex;
+	unsigned int vertexCount;
+
+	int matrix; //The mvp matrix, from AddMatrix
+	int paletteOffset; //Where the bones start in the skinning palette, -1 if it isn't skinned
+
+	DrawItem() : program(0), vao(0), texture(RENDER_ANY_TEXTURE), wireframe(false), numIndices(0), baseIndex(0), baseVertex(0), vertexCount(0), matrix(-1), paletteOffset(-1) {}
+};
+
+//State changes a queue makes, or would make, drawing its items in order
+struct RenderStats
+{
+	int draws;
+	int programSwitches;
+	int vaoSwitches;
+	int textureSwitches;
+
+	RenderStats() : draws(0), programSwitches(0), vaoSwitches(0), textureSwitches(0) {}
+};
+
+struct RenderSortEntry
+{
+	unsigned long long key;
+	int item;
+
+	bool operator<(const RenderSortEntry& other) const { return key < other.key || (key == other.key && item < other.item); }
+};
+
+//A frame's draws collected up and sorted so items sharing state are drawn together. Keys order by wireframe, then program,
+//then VAO, then texture, as switching programs costs the most, and a model's mesh entries share one VAO so keeping it
+//together comes before grouping textures. Ties keep the order they were added in. Submitting is done by RenderQueueSubmit.cpp
+//as it needs GL, everything here works headless.
+class RenderQueue
+{
+	private:
+
+		std::vector<DrawItem> items;
+		std::vector<glm::mat4> matrices;
+		std::vector<RenderSortEntry> order;
+
+	public:
+
+		//Wireframe in the top bit then 15 bits of program, 16 of VAO and 16 of texture. Names too big to fit only group
+		//less well, the state is compared in full when submitting.
+		static unsigned long long MakeKey(const DrawItem& item);
+
+		//Empties the queue, keeping the memory for the next frame
+		void Clear();
+
+		int AddMatrix(const glm::mat4& matrix);
+		void Add(const DrawItem& item);
+
+		void Sort();
+
+		//What drawing the items would cost in state changes, in sorted order or the order they were added in
+		RenderStats CountStateChanges(bool sorted) const;
+
+		//In sorted order once Sort has been called, otherwise in the order they were added
+		int GetNumItems() const { return order.size(); }
+		const DrawItem& GetItem(int index) const { return items[order[index].item]; }
+		const glm::mat4& GetMatrix(int index) const { return matrices[index]; }
+		unsigned long long GetKey(int index) const { return order[index].key; }
+		int GetAddedIndex(int index) const { return order[index].item; } //Where the item was in the order they were added
+
+		//Makes the draws with GL, in RenderQueueSubmit.cpp with the game
+		RenderStats Submit();
+};
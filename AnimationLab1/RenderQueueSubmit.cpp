@@ -0,0 +1,92 @@
+#include "RenderQueue.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+//Per frame, on the profiler overlay
+static ProfileCounter drawCalls("draw calls");
+static ProfileCounter programSwitches("program switches");
+static ProfileCounter vaoSwitches("VAO switches");
+static ProfileCounter textureSwitches("texture switches");
+
+//Only what differs from the item before is set. Uniforms belong to the program, so a new program has them all set again.
+RenderStats RenderQueue::Submit()
+{
+	PROFILE_SCOPE("RenderQueue::Submit");
+
+	ShaderManager* shaderManager = ShaderManager::Instance;
+	RenderStats stats;
+
+	unsigned int vao = 0;
+	unsigned int texture = RENDER_ANY_TEXTURE;
+	bool wireframe = false;
+	int matrix = -1;
+	int paletteOffset = -1;
+
+	glActiveTexture(GL_TEXTURE0);
+
+	for(int i = 0; i < GetNumItems(); i++)
+	{
+		const DrawItem& item = GetItem(i);
+
+		if(item.program != shaderManager->GetCurrentShaderProgramID())
+		{
+			shaderManager->SetShaderProgram(item.program);
+			stats.programSwitches++;
+
+			matrix = -1;
+			paletteOffset = -1;
+		}
+
+		if(i == 0 || item.vao != vao)
+		{
+			glBindVertexArray(item.vao);
+			vao = item.vao;
+			stats.vaoSwitches++;
+		}
+
+		if(item.texture != RENDER_ANY_TEXTURE && item.texture != texture)
+		{
+			glBindTexture(GL_TEXTURE_2D, item.texture);
+			texture = item.texture;
+			stats.textureSwitches++;
+		}
+
+		if(item.wireframe != wireframe)
+		{
+			glPolygonMode(GL_FRONT, item.wireframe ? GL_LINE : GL_FILL);
+			wireframe = item.wireframe;
+		}
+
+		if(item.matrix != matrix)
+		{
+			glUniformMatrix4fv(shaderManager->GetUniformLocation(UniformMvpMatrix), 1, GL_FALSE, glm::value_ptr(matrices[item.matrix]));
+			matrix = item.matrix;
+		}
+
+		if(item.paletteOffset >= 0 && item.paletteOffset != paletteOffset)
+		{
+			glUniform1i(shaderManager->GetUniformLocation(UniformPaletteOffset), item.paletteOffset);
+			paletteOffset = item.paletteOffset;
+		}
+
+		if(item.numIndices > 0)
+			glDrawElementsBaseVertex(GL_TRIANGLES, item.numIndices, GL_UNSIGNED_INT, (void*)(sizeof(unsigned int) * item.baseIndex), item.baseVertex);
+		else
+			glDrawArrays(GL_TRIANGLES, 0, item.vertexCount);
+
+		stats.draws++;
+	}
+
+	if(wireframe)
+		glPolygonMode(GL_FRONT, GL_FILL);
+
+	PROFILE_COUNT(drawCalls, stats.draws);
+	PROFILE_COUNT(programSwitches, stats.programSwitches);
+	PROFILE_COUNT(vaoSwitches, stats.vaoSwitches);
+	PROFILE_COUNT(textureSwitches, stats.textureSwitches);
+
+	return stats;
+}
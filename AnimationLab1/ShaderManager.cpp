@@ -1,47 +1,116 @@
 #include "ShaderManager.h"
-#include "Shader.h"
+#include "Common.h"
 
 ShaderManager* ShaderManager::Instance;
+ProfileCounter ShaderManager::GLQueries("GL queries");
 
-//Creates a program and adds it to the shader program list
-GLuint ShaderManager::CreateShaderProgram(std::string name, const std::string& vsFilename, const std::string& psFilename)
+ShaderManager::ShaderManager()
 {
-	GLuint shaderProgramID = glCreateProgram(); //https://www.opengl.org/sdk/docs/man2/xhtml/glCreateProgram.xml
-	
-	#pragma region ERROR CHECKING
-	if (shaderProgramID == 0) 
+	currentShaderProgramID = 0;
+	currentProgramInfo = 0;
+
+	//In StandardUniform's order
+	uniformNames.push_back("mvpMatrix");
+	uniformNames.push_back("palette");
+	uniformNames.push_back("paletteOffset");
+}
+
+#pragma region REFLECTION
+//Fills in the locations for any handles made since the program last looked
+void ShaderManager::ResolveHandles(ShaderProgramInfo& info)
+{
+	for(int handle = info.uniformLocations.size(); handle < uniformNames.size(); handle++)
 	{
-		fprintf(stderr, "Error creating shader program\n");
-		exit(1);
+		int location = -1;
+
+		for(int i = 0; i < info.uniforms.size(); i++)
+		{
+			if(info.uniforms[i].name == uniformNames[handle])
+				location = info.uniforms[i].location;
+		}
+
+		info.uniformLocations.push_back(location);
 	}
-	#pragma endregion
 
-	// Create two shader objects, one for the vertex, and one for the fragment shader
-	Shader vs;
-	vs.LoadFile(vsFilename);
-	vs.CompileShader(shaderProgramID, GL_VERTEX_SHADER);
-	//https://www.opengl.org/sdk/docs/man4/html/glCreateShader.xhtml
-	//https://www.opengl.org/sdk/docs/man/html/glShaderSource.xhtml
-	//https://www.opengl.org/sdk/docs/man/html/glCompileShader.xhtml
-	//https://www.opengl.org/sdk/docs/man/html/glAttachShader.xhtml
+	for(int handle = info.attributeLocations.size(); handle < attributeNames.size(); handle++)
+	{
+		int location = -1;
 
-	Shader ps;
-	ps.LoadFile(psFilename);
-	ps.CompileShader(shaderProgramID, GL_FRAGMENT_SHADER);
+		for(int i = 0; i < info.attributes.size(); i++)
+		{
+			if(info.attributes[i].name == attributeNames[handle])
+				location = info.attributes[i].location;
+		}
 
-	shaderProgramList[name] = shaderProgramID;
-	shaderProgramListReversed[shaderProgramID] = name;
-	
-	return shaderProgramID;
+		info.attributeLocations.push_back(location);
+	}
 }
 
-void ShaderManager::SetShaderProgram(GLuint shaderProgramID)
+int ShaderManager::GetUniformHandle(const std::string& name)
 {
-	if(currentShaderProgramID == shaderProgramID)
-		return;
+	for(int handle = 0; handle < uniformNames.size(); handle++)
+	{
+		if(uniformNames[handle] == name)
+			return handle;
+	}
 
-	// Note: this program will stay in effect for all draw calls until you replace it with another or explicitly disable its use
-	glUseProgram(shaderProgramID); //https://www.opengl.org/sdk/docs/man/html/glUseProgram.xhtml
+	uniformNames.push_back(name);
+	return uniformNames.size() - 1;
+}
+
+int ShaderManager::GetAttributeHandle(const std::string& name)
+{
+	for(int handle = 0; handle < attributeNames.size(); handle++)
+	{
+		if(attributeNames[handle] == name)
+			return handle;
+	}
+
+	attributeNames.push_back(name);
+	return attributeNames.size() - 1;
+}
+
+int ShaderManager::GetUniformLocation(unsigned int shaderProgramID, int handle)
+{
+	std::map<unsigned int, ShaderProgramInfo>::iterator found = programInfo.find(shaderProgramID);
 
-	currentShaderProgramID = shaderProgramID;
-}
\ No newline at end of file
+	if(found == programInfo.end() || handle < 0 || handle >= uniformNames.size())
+		return -1;
+
+	if(handle >= found->second.uniformLocations.size())
+		ResolveHandles(found->second);
+
+	return found->second.uniformLocations[handle];
+}
+
+int ShaderManager::GetAttributeLocation(unsigned int shaderProgramID, int handle)
+{
+	std::map<unsigned int, ShaderProgramInfo>::iterator found = programInfo.find(shaderProgramID);
+
+	if(found == programInfo.end() || handle < 0 || handle >= attributeNames.size())
+		return -1;
+
+	if(handle >= found->second.attributeLocations.size())
+		ResolveHandles(found->second);
+
+	return found->second.attributeLocations[handle];
+}
+
+int ShaderManager::GetUniformLocation(int handle)
+{
+	if(!currentProgramInfo || handle < 0 || handle >= uniformNames.size())
+		return -1;
+
+	if(handle >= currentProgramInfo->uniformLocations.size())
+		ResolveHandles(*currentProgramInfo);
+
+	return currentProgramInfo->uniformLocations[handle];
+}
+
+const ShaderProgramInfo* ShaderManager::GetProgramInfo(unsigned int shaderProgramID)
+{
+	std::map<unsigned int, ShaderProgramInfo>::iterator found = programInfo.find(shaderProgramID);
+
+	return found != programInfo.end() ? &found->second : 0;
+}
+#pragma endregion
\ No newline at end of file
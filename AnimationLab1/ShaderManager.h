@@ -1,38 +1,90 @@
 #ifndef _SHADERMANAGER_H                // Prevent multiple definitions if this 
 #define _SHADERMANAGER_H                // file is included in more than one place
 
-#include <GL/glew.h>
-#include <GL/freeglut.h>
-
 #include <string> 
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
 #include <map>
+#include <vector>
+
+#include "Profiler.h"
+
+//Handles for the uniforms set every frame, registered by the constructor in this order. Others can be had from GetUniformHandle.
+enum StandardUniform { UniformMvpMatrix = 0, UniformPalette, UniformPaletteOffset, NUM_STANDARD_UNIFORMS };
+
+//An active uniform or attribute of a linked program
+struct ShaderVariable
+{
+	std::string name; //Arrays without the [0]
+	int location;
+	unsigned int type; //The GL's enum for it
+	int size; //Elements, 1 unless it's an array
+};
+
+//Everything a program was found to have when it was created, so nothing needs asking of GL afterwards
+struct ShaderProgramInfo
+{
+	std::vector<ShaderVariable> uniforms;
+	std::vector<ShaderVariable> attributes;
+
+	//By handle, -1 where the program hasn't got one of that name
+	std::vector<int> uniformLocations;
+	std::vector<int> attributeLocations;
+};
 
+//GL names are plain integers, as in RenderQueue.h, so programs can be looked up by name in builds without GL, where
+//there are none and every name gives 0. Creating and setting programs needs GL, and is in ShaderManagerGL.cpp.
 class ShaderManager
 {
 	private:
-		std::map <std::string, GLuint> shaderProgramList;
-		std::map <GLuint, std::string> shaderProgramListReversed; //TODO - use boost multiindex
-		GLuint currentShaderProgramID;
+		std::map <std::string, unsigned int> shaderProgramList;
+		std::map <unsigned int, std::string> shaderProgramListReversed; //TODO - use boost multiindex
+		unsigned int currentShaderProgramID;
+
+		std::map <unsigned int, ShaderProgramInfo> programInfo;
+		ShaderProgramInfo* currentProgramInfo; //0 when no program is set
+
+		//Names by handle, shared by every program
+		std::vector<std::string> uniformNames;
+		std::vector<std::string> attributeNames;
+
+		void Reflect(unsigned int shaderProgramID, ShaderProgramInfo& info);
+		void ResolveHandles(ShaderProgramInfo& info);
 
 	public:
 
 		static ShaderManager* Instance;
 
+		static ProfileCounter GLQueries; //glGet calls, which stall until the GL has caught up. Should be 0 most frames.
+
+		ShaderManager();
+
 		void Init() { Instance = this; }
 
-		GLuint CreateShaderProgram(std::string name, const std::string& vsFilename, const std::string& psFilename);
+		unsigned int CreateShaderProgram(std::string name, const std::string& vsFilename, const std::string& psFilename);
 		
 		void SetShaderProgram(std::string shaderProgramName) { SetShaderProgram(shaderProgramList[shaderProgramName]); };
-		void SetShaderProgram(GLuint shaderProgramID);
+		void SetShaderProgram(unsigned int shaderProgramID);
 
-		GLuint GetShaderProgramID(std::string shaderProgramName) { return shaderProgramList[shaderProgramName]; }
-		std::string GetShaderProgramName(GLuint ID) { return shaderProgramListReversed[ID]; }
+		unsigned int GetShaderProgramID(std::string shaderProgramName) { return shaderProgramList[shaderProgramName]; }
+		std::string GetShaderProgramName(unsigned int ID) { return shaderProgramListReversed[ID]; }
 		
-		GLuint GetCurrentShaderProgramID() { return currentShaderProgramID; }
+		unsigned int GetCurrentShaderProgramID() { return currentShaderProgramID; }
+
+		//Handles stand for a name in every program. Get them once up front, looking one up searches the names.
+		int GetUniformHandle(const std::string& name);
+		int GetAttributeHandle(const std::string& name);
+
+		//-1 if the program hasn't got it. No GL calls and no string compares, once the handle has been seen by the program.
+		int GetUniformLocation(unsigned int shaderProgramID, int handle);
+		int GetAttributeLocation(unsigned int shaderProgramID, int handle);
+
+		//For the program set with SetShaderProgram
+		int GetUniformLocation(int handle);
+
+		const ShaderProgramInfo* GetProgramInfo(unsigned int shaderProgramID);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "ShaderManager.h"
+#include "Shader.h"
+#include "Common.h"
+
+#include <GL/glew.h>
+
+//The half of ShaderManager that talks to the GL, left out of builds without it
+
+//Creates a program and adds it to the shader program list
+GLuint ShaderManager::CreateShaderProgram(std::string name, const std::string& vsFilename, const std::string& psFilename)
+{
+	GLuint shaderProgramID = glCreateProgram(); //https://www.opengl.org/sdk/docs/man2/xhtml/glCreateProgram.xml
+	
+	#pragma region ERROR CHECKING
+	if (shaderProgramID == 0) 
+	{
+		fprintf(stderr, "Error creating shader program\n");
+		exit(1);
+	}
+	#pragma endregion
+
+	// Create two shader objects, one for the vertex, and one for the fragment shader
+	Shader vs;
+	vs.LoadFile(vsFilename);
+	vs.CompileShader(shaderProgramID, GL_VERTEX_SHADER);
+	//https://www.opengl.org/sdk/docs/man4/html/glCreateShader.xhtml
+	//https://www.opengl.org/sdk/docs/man/html/glShaderSource.xhtml
+	//https://www.opengl.org/sdk/docs/man/html/glCompileShader.xhtml
+	//https://www.opengl.org/sdk/docs/man/html/glAttachShader.xhtml
+
+	Shader ps;
+	ps.LoadFile(psFilename);
+	ps.CompileShader(shaderProgramID, GL_FRAGMENT_SHADER);
+
+	shaderProgramList[name] = shaderProgramID;
+	shaderProgramListReversed[shaderProgramID] = name;
+
+	ShaderProgramInfo& info = programInfo[shaderProgramID];
+	Reflect(shaderProgramID, info);
+
+	//Samplers keep their unit, so the palette's only needs setting the once
+	if(info.uniformLocations[UniformPalette] >= 0)
+	{
+		glUseProgram(shaderProgramID);
+		glUniform1i(info.uniformLocations[UniformPalette], PALETTE_TEXTURE_UNIT);
+		glUseProgram(currentShaderProgramID);
+	}
+	
+	return shaderProgramID;
+}
+
+void ShaderManager::SetShaderProgram(GLuint shaderProgramID)
+{
+	if(currentShaderProgramID == shaderProgramID)
+		return;
+
+	// Note: this program will stay in effect for all draw calls until you replace it with another or explicitly disable its use
+	glUseProgram(shaderProgramID); //https://www.opengl.org/sdk/docs/man/html/glUseProgram.xhtml
+
+	currentShaderProgramID = shaderProgramID;
+
+	std::map<GLuint, ShaderProgramInfo>::iterator found = programInfo.find(shaderProgramID);
+	currentProgramInfo = found != programInfo.end() ? &found->second : 0;
+}
+
+#pragma region REFLECTION
+//Asks the GL for every active uniform and attribute, the only time it's asked
+void ShaderManager::Reflect(GLuint shaderProgramID, ShaderProgramInfo& info)
+{
+	GLint count = 0;
+	GLchar name[256];
+
+	glGetProgramiv(shaderProgramID, GL_ACTIVE_UNIFORMS, &count);
+	PROFILE_COUNT(GLQueries, 1);
+
+	for(int i = 0; i < count; i++)
+	{
+		ShaderVariable variable;
+		GLsizei length = 0;
+
+		glGetActiveUniform(shaderProgramID, i, sizeof(name), &length, &variable.size, &variable.type, name);
+		variable.location = glGetUniformLocation(shaderProgramID, name);
+		PROFILE_COUNT(GLQueries, 2);
+
+		variable.name = name;
+
+		//Arrays come back as name[0], which is also where their first element is
+		if(variable.name.size() > 3 && variable.name.compare(variable.name.size() - 3, 3, "[0]") == 0)
+			variable.name.erase(variable.name.size() - 3);
+
+		info.uniforms.push_back(variable);
+	}
+
+	glGetProgramiv(shaderProgramID, GL_ACTIVE_ATTRIBUTES, &count);
+	PROFILE_COUNT(GLQueries, 1);
+
+	for(int i = 0; i < count; i++)
+	{
+		ShaderVariable variable;
+		GLsizei length = 0;
+
+		glGetActiveAttrib(shaderProgramID, i, sizeof(name), &length, &variable.size, &variable.type, name);
+		variable.location = glGetAttribLocation(shaderProgramID, name);
+		PROFILE_COUNT(GLQueries, 2);
+
+		variable.name = name;
+		info.attributes.push_back(variable);
+	}
+
+	ResolveHandles(info);
+}
+#pragma endregion
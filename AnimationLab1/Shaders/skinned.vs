@@ -6,10 +6,17 @@ layout(location = 2) in vec2 texture_coord;
 layout (location = 3) in ivec4 bone_id;
 layout (location = 4) in vec4 Weights;
 
-const int MAX_BONES = 32;
-
 uniform mat4 mvpMatrix;
-uniform mat4 boneMatrices[MAX_BONES];
+
+uniform samplerBuffer palette; //Every skinned model's bone matrices, a column per texel
+uniform int paletteOffset; //Where this model's start
+
+mat4 BoneMatrix(int boneID)
+{
+	int texel = (paletteOffset + boneID) * 4;
+
+	return mat4(texelFetch(palette, texel), texelFetch(palette, texel + 1), texelFetch(palette, texel + 2), texelFetch(palette, texel + 3));
+}
 
 out vec3 normal;
 out vec2 texCoord;
@@ -19,10 +26,10 @@ void main()
 {
 	vec4 Vertex = vec4(vertex_position.x, vertex_position.y, vertex_position.z, 1.0);
 
-	mat4 BoneTransform = boneMatrices[bone_id[0]] * Weights[0];
-    BoneTransform     += boneMatrices[bone_id[1]] * Weights[1];
-    BoneTransform     += boneMatrices[bone_id[2]] * Weights[2];
-    BoneTransform     += boneMatrices[bone_id[3]] * Weights[3];
+	mat4 BoneTransform = BoneMatrix(bone_id[0]) * Weights[0];
+    BoneTransform     += BoneMatrix(bone_id[1]) * Weights[1];
+    BoneTransform     += BoneMatrix(bone_id[2]) * Weights[2];
+    BoneTransform     += BoneMatrix(bone_id[3]) * Weights[3];
 
 	gl_Position = mvpMatrix * BoneTransform * Vertex;
 
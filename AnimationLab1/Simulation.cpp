@@ -0,0 +1,232 @@
+#include "Simulation.h"
+#include "ShaderManager.h"
+#include "LevelEditor.h"
+#include "AnimationLOD.h"
+#include "Profiler.h"
+#include "Timer.h"
+
+using namespace std;
+
+vector<Model*> objectList;
+
+Camera camera;
+Player* player;
+NPC* donald;
+
+Spline cameraSpline;
+Spline cactuarSpline;
+
+bool keyStates[256] = {false}; // Create an array of boolean values of length 256 (0-255)
+
+FixedTimestep scheduler;
+JobSystem* jobSystem;
+
+vector<Skeleton*> animatedSkeletons; //Rebuilt every frame, kept around so it doesn't reallocate
+vector<Model*> animatedModels; //The model each of animatedSkeletons belongs to
+
+int bonesEvaluated = 0;
+int bonesTotal = 0;
+
+SimulationTimings simulationTimings;
+
+bool loadScene(Gamepad* gamepad)
+{
+	PROFILE_SCOPE("loadScene");
+
+	Node::objectList = &objectList;
+
+	vector<Model*> loadedObjects = LevelEditor::Load(8);
+	objectList.insert(objectList.end(), loadedObjects.begin(), loadedObjects.end());
+	
+	Model* soraModel = new Model(glm::vec3(15,0,0), glm::mat4(1), glm::vec3(.6), "Models/sora.dae", ShaderManager::Instance->GetShaderProgramID("skinned"), false);
+	Model* donaldModel = new Model(glm::vec3(5,0,0), glm::mat4(1), glm::vec3(.1), "Models/don1.dae", ShaderManager::Instance->GetShaderProgramID("skinned"), false);
+
+	//The characters are nothing without their skeletons, which a mesh that didn't load leaves them without
+	if(!soraModel->HasSkeleton() || !donaldModel->HasSkeleton())
+		return false;
+
+	player = new Player(objectList, &camera, gamepad, soraModel); 
+	donald = new NPC(objectList, donaldModel, player);
+
+	cameraSpline.SetSpeed(10.0f);
+	cameraSpline.Load(2, false);
+	cameraSpline.constantSpeed = true;
+
+	Spline donaldSpline;
+	donaldSpline.SetSpeed(3.0f);
+	donaldSpline.Load(11, false);
+	donaldSpline.constantSpeed = true;
+	donaldSpline.mode = InterpolationMode::Cubic;
+
+	donald->patrol = donaldSpline;
+	donald->patrolling = true;
+
+	cactuarSpline.mode = InterpolationMode::None;
+	cactuarSpline.Load(25, false);
+	cactuarSpline.SetSpeed(2.0f);
+
+	return true;
+}
+
+void simulate(double stepTime)
+{
+	PROFILE_SCOPE("simulate");
+
+	for(int i = 0; i < objectList.size(); i++)
+		objectList[i]->SaveWorldProperties();
+
+	Timer timer;
+
+	player->ProcessKeyboardContinuous(keyStates, stepTime);
+	player->Update(stepTime);
+	donald->Update(stepTime); //TODO - make a character class with functions for update / input etc.
+
+	simulationTimings.characters += timer.ElapsedMilliseconds();
+	timer.Reset();
+	
+	//Animation
+	//Characters don't share any animation state, so each skeleton is a job of its own
+	animatedSkeletons.clear();
+	animatedModels.clear();
+	for(int i = 0; i< objectList.size(); i++)
+	{
+		if(objectList[i]->HasSkeleton())
+		{
+			Skeleton* skeleton = objectList[i]->GetSkeleton();
+
+			float distance = glm::distance(camera.viewProperties.position, objectList[i]->worldProperties.translation);
+			skeleton->SetLOD(AnimationLOD::SelectLevel(distance));
+
+			animatedSkeletons.push_back(skeleton);
+			animatedModels.push_back(objectList[i]);
+		}
+	}
+
+	jobSystem->ParallelFor(animatedSkeletons.size(), [stepTime](int i)
+	{
+		//TODO - If animationMode == IK .. and so on
+		//	if(objectList[i]->GetSkeleton()->ikChains.size() > 0)
+		//		objectList[i]->GetSkeleton()->ComputeIK("chain1", /*glm::vec3(0,5,0)*/target->worldProperties.translation, 50, objectList[i]->GetModelMatrix()); //replace with iteration, ikchain should be a struct with a target?
+		//																											//if no target do nothing?
+
+		PROFILE_SCOPE("animate skeleton");
+
+		Skeleton* skeleton = animatedSkeletons[i];
+
+		//Distant skeletons skip frames, and keep their last transforms on the ones they skip
+		if(skeleton->AnimateAtLOD(stepTime)) //this overwrites control above
+		{
+			skeleton->UpdateGlobalTransforms();
+
+			//Only does anything for models that have had EnableCpuSkinning called
+			animatedModels[i]->UpdateCpuSkinning();
+		}
+	});
+
+	bonesEvaluated = bonesTotal = 0;
+	for(int i = 0; i < animatedSkeletons.size(); i++)
+	{
+		bonesEvaluated += animatedSkeletons[i]->lastBonesEvaluated;
+		bonesTotal += animatedSkeletons[i]->GetNumBones();
+	}
+
+	simulationTimings.animation += timer.ElapsedMilliseconds();
+	timer.Reset();
+
+	for(int i = 0; i< objectList.size(); i++)
+		objectList[i]->Update(stepTime);
+
+	simulationTimings.models += timer.ElapsedMilliseconds();
+	timer.Reset();
+
+	/*if(objectList.size() == 2)
+		objectList[0]->worldProperties.orientation *= glm::toMat4(glm::angleAxis(1.0f, glm::vec3(0,1,0)));*/
+
+	//FOR ITERATING SUBCHAINS
+	//std::map<char,int>::iterator it;
+	//for (std::map<char,int>::iterator it=mymap.begin(); it!=mymap.end(); ++it)
+	//std::cout << it->first << " => " << it->second << '\n';
+
+	cactuarSpline.Update(stepTime);
+
+	if(!donald->questComplete)
+	{
+		bool check = false;
+		for(int i = 0; i < objectList.size(); i++)
+		{
+			if(objectList[i]->GetFileName() == "Models/jumbo.dae")//TODO make a cactuar class
+			{
+				if(objectList[i]->drawMe)
+				{
+					check = true;
+
+					objectList[i]->worldProperties.translation.y = cactuarSpline.GetPosition().y;
+
+					if(player->GetState() == 2)
+					{
+						if(glm::distance(player->model->worldProperties.translation, objectList[i]->worldProperties.translation) < 2.5)
+						{
+							objectList[i]->die = true;
+						}
+					}
+				}
+			}
+		}
+
+		if(check == false)
+			donald->questComplete = true;
+	}
+
+	simulationTimings.world += timer.ElapsedMilliseconds();
+}
+
+int runHeadless(int numFrames, bool cpuSkinning)
+{
+	Model::Headless = true;
+
+	camera.Init(glm::vec3(0.0f, 0.0f, 0.0f), 0.0002f, 0.01f); 
+
+	jobSystem = new JobSystem();
+	jobSystem->Init();
+
+	static ShaderManager shaderManager;
+	shaderManager.Init(); //No programs, so everything gets 0
+
+	if(!loadScene(0))
+	{
+		fprintf(stderr, "Nothing to simulate, the characters didn't load\n");
+		return 1;
+	}
+
+	for(int i = 0; i < objectList.size() && cpuSkinning; i++)
+	{
+		if(objectList[i]->HasSkeleton())
+			objectList[i]->EnableCpuSkinning();
+	}
+
+	printf("\nHeadless, %i frames of %.2f ms, %i objects, %i threads\n", numFrames, scheduler.stepTime, (int)objectList.size(), JobSystem::GetHardwareThreads());
+
+	simulationTimings = SimulationTimings();
+
+	Timer timer;
+	for(int frame = 0; frame < numFrames; frame++)
+	{
+		simulate(scheduler.stepTime);
+		Profiler::EndFrame();
+	}
+
+	double totalTime = timer.ElapsedMilliseconds();
+
+	const char* names[] = { "characters", "animation", "models", "world" };
+	double times[] = { simulationTimings.characters, simulationTimings.animation, simulationTimings.models, simulationTimings.world };
+
+	for(int i = 0; i < ARRAY_SIZE_IN_ELEMENTS(times); i++)
+		printf("    %-12s %10.2f ms %8.4f ms/frame %5.1f%%\n", names[i], times[i], times[i] / numFrames, 100.0 * times[i] / totalTime);
+
+	printf("    %-12s %10.2f ms %8.4f ms/frame\n", "total", totalTime, totalTime / numFrames);
+	printf("    %.1f frames per second, %.1fx real time\n", numFrames * 1000.0 / totalTime, numFrames * scheduler.stepTime / totalTime);
+
+	Profiler::ExportChromeTrace("profile_headless.json");
+
+	return 0;
+}
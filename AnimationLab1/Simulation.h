@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "Model.h"
+#include "Camera.h"
+#include "Player.h"
+#include "NPC.h"
+#include "Spline.h"
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+
+//The game's world and the step that moves it on. Nothing here needs a window, the GL or Windows, so the game and the
+//headless runner share it, and the headless runner builds on Linux from CMakeLists.txt.
+
+//Where simulate's time goes, summed over every step since it was last reset, in ms
+struct SimulationTimings
+{
+	double characters; //Player and NPC logic
+	double animation;
+	double models;
+	double world; //Splines and the quest
+
+	SimulationTimings() : characters(0), animation(0), models(0), world(0) {}
+};
+
+extern std::vector<Model*> objectList;
+
+extern Camera camera;
+extern Player* player;
+extern NPC* donald;
+
+extern Spline cameraSpline;
+extern Spline cactuarSpline;
+
+extern bool keyStates[256];
+
+extern FixedTimestep scheduler; //Runs simulate at a fixed rate
+extern JobSystem* jobSystem;
+
+extern int bonesEvaluated; //Bones animated last frame, after the LOD has had its way
+extern int bonesTotal;
+
+extern SimulationTimings simulationTimings;
+
+//The level, the characters and the splines they follow. Programs are looked up by name through ShaderManager::Instance.
+//False if either character's mesh didn't load, as happens when it isn't baked and the build can't import source files.
+bool loadScene(Gamepad* gamepad);
+
+void simulate(double stepTime);
+
+//Runs the game's simulation with no window, GL or gamepad, one step after another as fast as it will go,
+//for soak tests and measuring throughput on machines without a display. With cpuSkinning the skinned models'
+//vertices are skinned every step as well, as they would be on a machine with no GPU to do it.
+int runHeadless(int numFrames, bool cpuSkinning);
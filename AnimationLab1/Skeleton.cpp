@@ -1,149 +1,142 @@
 #include "Skeleton.h"
 #include <sstream>
 #include <iostream>
-#include "Model.h"
+#include "AllocationCounter.h"
+#include "JobSystem.h"
+#include "SkinningKernel.h"
+#include "Profiler.h"
 
 bool Skeleton::ConstraintsEnabled = true;
 float Skeleton::AnimationSpeedScalar = 1.0f;
 
+
 float AnimationController::blendScalar = 1.0f;
 bool AnimationController::frozen = true;
 
-Skeleton::Skeleton(Model* p_myModel)
+bool AnimationLOD::Enabled = true;
+AnimationLODSettings AnimationLOD::Levels[NUM_ANIMATION_LODS] = 
+{
+	{ 15.0f, 1, false, false },
+	{ 40.0f, 2, true, false },
+	{ 0.0f, 4, true, true },
+};
+
+int Skeleton::nextLODPhase = 0;
+
+Skeleton::Skeleton(const SkeletonDefinition* p_definition)
 {
 	hasKeyframes = false;
-	model = p_myModel; // for the model matrix
+	lastAnimateAllocations = 0;
+	definition = p_definition;
+
+	int numBones = definition->GetNumBones();
+
+	localTransforms = definition->GetBindTransforms();
+	globalTransforms.assign(numBones, glm::mat4(1));
+	finalTransforms.assign(numBones, glm::mat4(1));
+
+	lastTranslations = olderTranslations = definition->GetBindTranslations();
+	lastOrientations = olderOrientations = definition->GetBindOrientations();
+	inertialOffsets.assign(numBones, InertialBoneOffset());
+
+	inertializing = false;
+	beginInertialization = false;
+	inertializationTime = 0.0f;
+	inertializationDuration = 0.0f;
+	lastDeltaTime = 0.0f;
+
+	lodLevel = 0;
+	framesSinceUpdate = nextLODPhase++ % 4;
+	savedDeltaTime = 0.0;
+	cheapInterpolation = false;
+	lastBonesEvaluated = 0;
 }
 
 Skeleton::~Skeleton()
 {
-	//TODO - release bone memory
+	for(int i = 0; i < animations.size(); i++)
+		delete animations[i];
 }
 
-bool Skeleton::ImportAssimpBoneHierarchy(const aiScene* scene, aiNode* aiBone, Bone* parent, bool print)
-{
-	Bone* bone = new Bone;
-	strcpy(bone->name ,aiBone->mName.data);
+void Skeleton::UpdateGlobalTransforms(int firstBoneID) 
+{	
+	PROFILE_SCOPE("Skeleton::UpdateGlobalTransforms");
 
-	for (int i = 0; i < (int)aiBone->mNumChildren; i++) 
-		ImportAssimpBoneHierarchy (scene, aiBone->mChildren[i], bone, print); //depth first
+	//Parents come before their children, so a single pass front to back always finds the parent's global transform up to date.
+	//Starting part way through still catches every descendant of firstBoneID, as they all come after it
+	int numBones = definition->GetNumBones();
 
-	if(print)
-	{
-		std::stringstream ss;
-		ss << "\n\nIs " << bone->name << " a bone?";
-		std::cout << ss.str();
-	}
-
-	for(int meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++) //For every mesh
-	{
-		for(int boneIdx = 0; boneIdx < scene->mMeshes[meshIdx]->mNumBones; boneIdx++) //For every bone in said mesh
-		{
-			if (strcmp (scene->mMeshes[meshIdx]->mBones[boneIdx]->mName.data, bone->name) == 0) //Is this node actually a bone?
-			{
-				if(std::find(bonesAdded.begin(), bonesAdded.end(), bone->name) == bonesAdded.end())
-				{
-					bone->id = bones.size();
-					bones[bone->id] = bone;
-
-					bonesAdded.push_back(bone->name);
-					boneNameToID[bone->name] = bone->id; //TODO - make this nicer
-
-					//bone->aibone = scene->mMeshes[meshIdx]->mBones[boneIdx]; //for grabbing weights
-
-					#pragma region TODO - Copy out weights
-					//TODO - copy out weights too
-					/*for(int weightIdx = 0; weightIdx < scene->mMeshes[meshIdx]->mBones[boneIdx]->mNumWeights; weightIdx++)
-					{
-						aiVertexWeight aiWeight = scene->mMeshes[meshIdx]->mBones[boneIdx]->mWeights[weightIdx];
-						Weight weight;
-						weight.vertexID = aiWeight.mVertexId;
-						weight.weighting = aiWeight.mWeight;
-
-						bone->weights.push_back(weight);
-					}*/
-					#pragma endregion
-
-					bone->parent = parent;
-					bone->parent->children.push_back(bone);
-					
-					bone->offset = convertAssimpMatrix(scene->mMeshes[meshIdx]->mBones[boneIdx]->mOffsetMatrix);
-					bone->inv_offset = glm::inverse(bone->offset);
-
-					bone->transform = convertAssimpMatrix(aiBone->mTransformation);
-
-					root = bone->parent; //The last guy to get in here is the root, as it is depth first
-
-					bone->applyKeyframeFlag = false;
-
-					#pragma region PRINT OUT
-					if(print)
-					{
-						glm::vec3 offsetTranslation = decomposeT(bone->offset);
-						glm::vec3 mTransformTranslation = decomposeT(convertAssimpMatrix(aiBone->mTransformation));
-
-						std::stringstream ss;
-						ss << "\nYES!";
-						ss << "\nbone->name: " << bone->name;
-						ss << "\nbone->parent: " << bone->parent->name;
-						ss << "\nnumberOfChildren: " << bone->children.size();
-						ss << "\nbone->offset: (x:" << offsetTranslation.x << ", y: " << offsetTranslation.y << ", z: " << offsetTranslation.z << ")";
-						ss << "\nmTransform: (x:" << mTransformTranslation.x << ", y: " << mTransformTranslation.y << ", z: " << mTransformTranslation.z << ")";
-						std::cout << ss.str();
-					}
-					#pragma endregion
-					
-					
-					break; 
-				}
-			}
-		}
-	}
+	if(firstBoneID >= numBones)
+		return;
 
-	return true;
+	ComputeSkinningMatrices(&definition->GetParentIDs()[0], &localTransforms[0], &definition->GetOffsets()[0], 
+		&globalTransforms[0], &finalTransforms[0], firstBoneID, numBones);
 }
 
-#pragma region DEBUGGING PRINTOUTS
-void Skeleton::PrintHeirarchy(Bone* bone)
+BoundingBox Skeleton::GetSkinnedBounds()
 {
-	printf("\nbone->name: %s \n", bone->name);
-	printf("bone->parent: %i \n", bone->parent->name);
+	const std::vector<BoundingBox>& boneBounds = definition->GetBoneBounds();
+	BoundingBox bounds;
 
-	printf("numberOfChildren: %i \n", bone->children.size());
+	//A skinned vertex is a weighted average of where each of its bones would put it, so it's inside the box around those
+	for(int i = 0; i < boneBounds.size() && i < finalTransforms.size(); i++)
+	{
+		if(!boneBounds[i].IsEmpty())
+			bounds.Add(TransformBox(boneBounds[i], finalTransforms[i]));
+	}
 
-	for(int i = 0; i < bone->children.size(); i++)
-		PrintHeirarchy(bone->children[i]);
+	return bounds;
 }
 
-void Skeleton::PrintAiHeirarchy(aiNode* bone)
+glm::vec3 Skeleton::GetMeshSpacePosition(int boneID)
 {
-	printf("\nbone->name: %s \n", bone->mName.C_Str());
-	printf("bone->parent: %i \n", bone->mParent->mName.C_Str());
-
-	printf("numberOfChildren: %i \n", bone->mNumChildren);
-
-	for(int i = 0; i < bone->mNumChildren; i++)
-		PrintAiHeirarchy(bone->mChildren[i]);
+	const glm::mat4& matAbs = globalTransforms[boneID]; //i.e. finalTransform * inverse(offset)
+
+	return glm::vec3
+	(
+		matAbs[3][0], 
+		matAbs[3][1],
+		matAbs[3][2]
+	);
 }
-#pragma endregion
 
-void Skeleton::UpdateGlobalTransforms(Bone* bone, glm::mat4 parentTransform) 
-{	
-	bone->globalTransform = parentTransform * bone->transform;
+glm::vec3 Skeleton::GetEulerAngles(int boneID)
+{
+	glm::vec3 translation;
+	glm::mat4 rotation; 
+	glm::vec3 scaling;
 	
-	bone->finalTransform = /*model->globalInverseTransform **/ bone->globalTransform * bone->offset;
+	decomposeTRS(localTransforms[boneID], translation, rotation, scaling); 
 
-	for (int i = 0; i < bone->children.size(); i++) 
-		UpdateGlobalTransforms (bone->children[i], bone->globalTransform); 
+	return glm::eulerAngles(glm::toQuat(rotation));
 }
 
 void Skeleton::Animate(double deltaTime)
 {
+	PROFILE_SCOPE("Skeleton::Animate");
+
 	if(!hasKeyframes)
 		return;
 
+	long allocationsBefore = AllocationCounter::Count();
+
 	animationController.Update(deltaTime);
 
+	if(animationController.inertializationRequested)
+	{
+		animationController.inertializationRequested = false;
+
+		inertializing = animationController.inertializationDuration > 0.0f;
+		beginInertialization = inertializing;
+		inertializationTime = 0.0f;
+		inertializationDuration = animationController.inertializationDuration;
+	}
+	else if(inertializing)
+	{
+		inertializationTime += (deltaTime/1000) * AnimationController::blendScalar;
+		inertializing = inertializationTime < inertializationDuration;
+	}
+
 	//Update clocks
 	for(int aniIdx = 0; aniIdx < animations.size(); aniIdx++)
 	{
@@ -161,34 +154,121 @@ void Skeleton::Animate(double deltaTime)
 		}
 	}
 
-	//Each bone has a vector of contributing poses
+	cheapInterpolation = AnimationLOD::Levels[lodLevel].cheapInterpolation;
+
+	//Each bone has a list of contributing poses in the pose buffer
 	//Sample the keyframes to populate the poses for each bone based on the current timer
-	std::map<int, vector<Pose>> contributingPoses = SampleKeyframes();	
+	SampleKeyframes();
+
+	lastBonesEvaluated = 0;
+	for(int boneIdx = 0; boneIdx < poseBuffer.numBones; boneIdx++)
+	{
+		if(poseBuffer.GetPoseCount(boneIdx) > 0)
+			lastBonesEvaluated++;
+	}
 
 	//Loop through each bone and update their transforms based on the contributing poses
-	for(int boneIdx = 0; boneIdx < bones.size(); boneIdx++)
+	//Bones don't depend on each other here, so very large rigs spread them over the job system
+	if(poseBuffer.numBones >= PARALLEL_BONE_THRESHOLD && JobSystem::Instance)
 	{
-		if(contributingPoses[boneIdx].size() == 1)
+		JobSystem::Instance->ParallelFor(poseBuffer.numBones, [this](int boneIdx) { BlendPose(boneIdx); }, PARALLEL_BONE_GRAIN);
+	}
+	else
+	{
+		for(int boneIdx = 0; boneIdx < poseBuffer.numBones; boneIdx++)
+			BlendPose(boneIdx);
+	}
+
+	beginInertialization = false;
+	lastDeltaTime = deltaTime/1000;
+
+	lastAnimateAllocations = AllocationCounter::Count() - allocationsBefore;
+}
+
+void Skeleton::BlendPose(int boneIdx)
+{
+	int poseCount = poseBuffer.GetPoseCount(boneIdx);
+
+	if(poseCount == 0)
+		return;
+
+	glm::vec3 translation;
+	glm::quat orientation;
+	float totalWeight = 0.0f;
+
+	//Weighted average of the override poses, blending each one into the running result by its share of the weight so far
+	for(int layer = 0; layer < poseCount; layer++)
+	{
+		float weight = poseBuffer.GetWeight(boneIdx, layer);
+
+		if(poseBuffer.IsAdditive(boneIdx, layer) || weight <= 0.0f)
+			continue;
+
+		totalWeight += weight;
+
+		if(totalWeight == weight)
 		{
-			bones[boneIdx]->transform = glm::translate(glm::mat4(1), contributingPoses[boneIdx][0].translation)
-				* glm::toMat4(contributingPoses[boneIdx][0].orientation);
+			translation = poseBuffer.GetTranslation(boneIdx, layer);
+			orientation = poseBuffer.GetOrientation(boneIdx, layer);
 		}
-		else if (contributingPoses[boneIdx].size() == 2)
+		else
 		{
-			glm::mat4 translation = glm::translate(glm::mat4(1), lerp(contributingPoses[boneIdx][0].translation, 
-				contributingPoses[boneIdx][1].translation, contributingPoses[boneIdx][1].weight));
+			float t = weight / totalWeight;
+
+			translation = lerp(translation, poseBuffer.GetTranslation(boneIdx, layer), t);
+
+			if(cheapInterpolation)
+				orientation = Nlerp(orientation, poseBuffer.GetOrientation(boneIdx, layer), t);
+			else
+				orientation = glm::slerp(orientation, poseBuffer.GetOrientation(boneIdx, layer), t);
+		}
+	}
+
+	if(totalWeight == 0.0f) //Only additive poses
+	{
+		translation = definition->GetBindTranslations()[boneIdx];
+		orientation = definition->GetBindOrientations()[boneIdx];
+	}
+
+	for(int layer = 0; layer < poseCount; layer++)
+	{
+		if(!poseBuffer.IsAdditive(boneIdx, layer))
+			continue;
+
+		float weight = glm::min(poseBuffer.GetWeight(boneIdx, layer), 1.0f);
 
-			glm::mat4 orientation = glm::toMat4(glm::slerp(contributingPoses[boneIdx][0].orientation, 
-				contributingPoses[boneIdx][1].orientation, contributingPoses[boneIdx][1].weight));
+		translation += poseBuffer.GetTranslation(boneIdx, layer) * weight;
+		orientation = glm::normalize(orientation * glm::slerp(glm::quat(), poseBuffer.GetOrientation(boneIdx, layer), weight));
+	}
 
-			bones[boneIdx]->transform = translation * orientation; 
+	if(inertializing)
+	{
+		if(beginInertialization)
+		{
+			BeginInertialization(inertialOffsets[boneIdx], translation, orientation, 
+				lastTranslations[boneIdx], lastOrientations[boneIdx], olderTranslations[boneIdx], olderOrientations[boneIdx], 
+				lastDeltaTime, inertializationDuration);
 		}
+
+		ApplyInertialization(inertialOffsets[boneIdx], inertializationTime, translation, orientation);
 	}
+
+	olderTranslations[boneIdx] = lastTranslations[boneIdx];
+	olderOrientations[boneIdx] = lastOrientations[boneIdx];
+	lastTranslations[boneIdx] = translation;
+	lastOrientations[boneIdx] = orientation;
+
+	ComposeTransform(translation, orientation, glm::vec3(1.0f), localTransforms[boneIdx]);
 }
 
-std::map<int, std::vector<Pose>> Skeleton::SampleKeyframes()
+void Skeleton::SampleKeyframes()
 {
-	std::map<int, std::vector<Pose>> contributingPoses;
+	PROFILE_SCOPE("Skeleton::SampleKeyframes");
+
+	if(poseBuffer.numBones != GetNumBones() || poseBuffer.maxLayers < animations.size()) //Only happens if no animation has been loaded yet
+		poseBuffer.Resize(GetNumBones(), std::max((int)animations.size(), MAX_ANIMATIONS));
+
+	poseBuffer.Clear();
 	
 	for(int aniIdx = 0; aniIdx < animations.size(); aniIdx++)
 	{
@@ -196,75 +276,125 @@ std::map<int, std::vector<Pose>> Skeleton::SampleKeyframes()
 
 		if(animation->weight > 0)
 		{
-			for(int boneIdx = 0; boneIdx < bones.size(); boneIdx++)
+			bool additive = animation->blendMode == BlendAdditive;
+			bool skipDetailBones = AnimationLOD::Levels[lodLevel].skipDetailBones && detailBones.size() == poseBuffer.numBones;
+			const float* mask = animation->maskID >= 0 && animation->maskID < boneMasks.size() ? &boneMasks[animation->maskID][0] : 0;
+
+			for(int trackIdx = 0; trackIdx < animation->GetNumTracks(); trackIdx++)
 			{
-				Pose pose;
-				glm::mat4 translation = glm::mat4(1);
-				glm::mat4 orientation = glm::mat4(1);
+				int boneID = animation->GetBoneID(trackIdx);
+
+				if(boneID < 0 || (skipDetailBones && detailBones[boneID]))
+					continue;
+
+				float weight = mask ? animation->weight * mask[boneID] : animation->weight;
 
-				BoneAnimationData* boneAnimationData = animation->animationData.at(boneIdx);
+				if(weight <= 0)
+					continue;
 
-				if(boneAnimationData->posKeyframes.size() > 0)// if this bone has keyframes
+				glm::vec3 translation = animation->SamplePosition(trackIdx);
+				glm::quat orientation = animation->SampleRotation(trackIdx, cheapInterpolation);
+
+				if(additive)
 				{
-					int prev_key = 0;
-					int next_key = 0;
+					translation -= animation->referencePositions[trackIdx];
+					orientation = glm::inverse(animation->referenceRotations[trackIdx]) * orientation;
+				}
+
+				poseBuffer.AddPose(boneID, translation, orientation, weight, additive);
+			}
+		}
+	}
+}
 
-					//Find the two keyframes
-					for (int keyidx = 0; keyidx < boneAnimationData->posKeyframes.size() - 1; keyidx++) 
-					{
-						prev_key = keyidx;
-						next_key = keyidx + 1;
+bool Skeleton::AnimateAtLOD(double deltaTime)
+{
+	savedDeltaTime += deltaTime;
 
-						if (boneAnimationData->posKeyframes[next_key]->time >= animation->localClock) // if the next keyframe is greater than the timer, then we have our two keyframes
-							break;
-					}
+	if(++framesSinceUpdate < AnimationLOD::Levels[lodLevel].updateInterval)
+	{
+		lastBonesEvaluated = 0;
+		return false;
+	}
 
-					float timeBetweenKeys = boneAnimationData->posKeyframes[next_key]->time - boneAnimationData->posKeyframes[prev_key]->time;
-					float t = (animation->localClock - boneAnimationData->posKeyframes[prev_key]->time) / timeBetweenKeys;
+	framesSinceUpdate = 0;
 
-					std::stringstream ss;
-					ss << "t: "<< t;
-					drawText(20,20, ss.str().c_str());
+	if(hasKeyframes)
+		Animate(savedDeltaTime);
 
-					//translation = glm::translate(glm::mat4(1), animation.boneAnimations[boneidx].posKeyframes[prev_key]->position); //TODO- add mode
-					pose.translation = lerp(boneAnimationData->posKeyframes[prev_key]->position, 
-						boneAnimationData->posKeyframes[next_key]->position, t);
-				}
+	savedDeltaTime = 0.0;
 
-				if (boneAnimationData->rotKeyframes.size() > 0)  // if this bone has keyframes
-				{
-					int prev_key = 0;
-					int next_key = 0;
-		
-					//Find the two keyframes
-					for (int keyidx = 0; keyidx < boneAnimationData->rotKeyframes.size() - 1; keyidx++) 
-					{
-						prev_key = keyidx;
-						next_key = keyidx + 1;
-
-						if (boneAnimationData->rotKeyframes[next_key]->time >= animation->localClock) // if the next keyframe is greater than the timer, then we have our two keyframes
-							break;
-					}
-
-					float timeBetweenKeys = boneAnimationData->rotKeyframes[next_key]->time - boneAnimationData->rotKeyframes[prev_key]->time;
-					float t = (animation->localClock - boneAnimationData->rotKeyframes[prev_key]->time) / timeBetweenKeys;
-	
-					glm::quat interpolatedquat = glm::slerp(boneAnimationData->rotKeyframes[prev_key]->rotation, 
-						boneAnimationData->rotKeyframes[next_key]->rotation, t);
+	return true;
+}
 
-					pose.orientation = interpolatedquat;
-				}
+void Skeleton::SetDetailBones(const char** boneNames, int count)
+{
+	int numBones = GetNumBones();
+	const std::vector<int>& parentIDs = definition->GetParentIDs();
+	detailBones.assign(numBones, 0);
 
-				pose.weight = animation->weight;
-				contributingPoses[boneAnimationData->boneID].push_back(pose);
-			}
-		}
+	for(int i = 0; i < count; i++)
+	{
+		int rootID = definition->GetBoneID(boneNames[i]);
+
+		if(rootID < 0)
+			continue; //Not every rig has every bone
+
+		detailBones[rootID] = 1;
+
+		for(int boneID = rootID + 1; boneID < numBones && parentIDs[boneID] >= rootID; boneID++)
+			detailBones[boneID] = 1;
 	}
+}
 
-	return contributingPoses;
+int Skeleton::CreateBoneMask(const std::string& boneName, float weight)
+{
+	int rootID = definition->GetBoneID(boneName);
+
+	if(rootID < 0)
+	{
+		fprintf(stderr, "Can't make a bone mask, there's no bone named %s\n", boneName.c_str());
+		return -1;
+	}
+
+	int numBones = GetNumBones();
+	const std::vector<int>& parentIDs = definition->GetParentIDs();
+
+	std::vector<float> mask(numBones, 0.0f);
+	mask[rootID] = weight;
+
+	//Descendants come straight after their ancestor, so the subtree ends at the first bone whose parent isn't in it
+	for(int boneID = rootID + 1; boneID < numBones; boneID++)
+	{
+		int parentID = parentIDs[boneID];
+
+		if(parentID < rootID)
+			break;
+
+		mask[boneID] = weight;
+	}
+
+	boneMasks.push_back(mask);
+
+	return boneMasks.size() - 1;
+}
+
+void Skeleton::SetAnimationLayer(int index, BlendMode blendMode, int maskID)
+{
+	if(index >= animations.size())
+		return;
+
+	Animation* animation = animations[index];
+
+	if(blendMode == BlendAdditive)
+		animation->MakeAdditive();
+	else
+		animation->blendMode = BlendOverride;
+
+	animation->maskID = maskID;
 }
 
-bool Skeleton::ComputeIK(std::string chainName, glm::vec3 T, int steps)
+bool Skeleton::ComputeIK(std::string chainName, glm::vec3 T, int steps, const glm::mat4& modelMatrix)
 {
 	float distanceThreshold = 0.01f;
 	
@@ -278,15 +408,15 @@ bool Skeleton::ComputeIK(std::string chainName, glm::vec3 T, int steps)
 
 	glm::vec3 B, E; //These need to be world positions
 
-	glm::mat4 modelMat = model->GetModelMatrix(); //Grab the model matrix out here as it won't be changing
+	const glm::mat4& modelMat = modelMatrix;
 	Bone* effector = links[effectorIdx];
 
 	do
 	{
 		Bone* bone = links[linkIdx]; //Bone we're currently working on
 
-		B = glm::vec3(modelMat * glm::vec4(bone->GetMeshSpacePosition(), 1));
-		E = glm::vec3(modelMat * glm::vec4(effector->GetMeshSpacePosition(), 1));
+		B = glm::vec3(modelMat * glm::vec4(GetMeshSpacePosition(bone->id), 1));
+		E = glm::vec3(modelMat * glm::vec4(GetMeshSpacePosition(effector->id), 1));
 
 		if(glm::distance(E, T) > distanceThreshold)
 		{
@@ -304,16 +434,16 @@ bool Skeleton::ComputeIK(std::string chainName, glm::vec3 T, int steps)
 			if(cosAngle < 0.9999f) // IF THE DOT PRODUCT RETURNS 1.0, I DON'T NEED TO ROTATE AS IT IS 0 DEGREES
 			{
 				glm::vec3 rotationAxis = glm::normalize(glm::cross(BE,BT));
-				rotationAxis = glm::mat3(glm::inverse(modelMat * bone->finalTransform * bone->inv_offset)) * rotationAxis;
+				rotationAxis = glm::mat3(glm::inverse(modelMat * globalTransforms[bone->id])) * rotationAxis;
 
 				rotation = glm::rotate(glm::mat4(1), turnAngle, rotationAxis);
 
-				bone->transform *= rotation;
+				localTransforms[bone->id] *= rotation;
 
 				if(ConstraintsEnabled)
 					ImposeDOFRestrictions(bone);
 
-				UpdateGlobalTransforms(bone, bone->parent->globalTransform);
+				UpdateGlobalTransforms(bone->id);
 			}
 
 			if(--linkIdx < 0)
@@ -341,7 +471,7 @@ void Skeleton::ImposeDOFRestrictions(Bone* bone)
 	glm::mat4 rotation; 
 	glm::vec3 scaling;
 	
-	decomposeTRS(bone->transform, translation, rotation, scaling); 
+	decomposeTRS(localTransforms[bone->id], translation, rotation, scaling); 
 
 /*      [0] [1] [2] [3]
  * [0] | 1   0   0   T1 | | R11 R12 R13 0 | | a 0 0 0 |   | aR11 bR12 cR13 T1 |
@@ -378,162 +508,33 @@ void Skeleton::ImposeDOFRestrictions(Bone* bone)
     euler = glm::radians(euler);
 	rotation = glm::eulerAngleZ(euler.z) * glm::eulerAngleY(euler.y) * glm::eulerAngleX(euler.x);
 
-	bone->transform = glm::translate(glm::mat4(1.0f), translation) 
+	localTransforms[bone->id] = glm::translate(glm::mat4(1.0f), translation) 
 				* rotation
 				* glm::scale(glm::mat4(1.0f), scaling);
 }
 
 bool Skeleton::LoadAnimation(const char* file_name)
 {
-	const aiScene* scene = aiImportFile (file_name, aiProcess_Triangulate | aiProcess_FlipUVs);
-	
-	if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) 
-	{
-		fprintf (stderr, "ERROR: reading animation %s\n", file_name);
+	const AnimationClip* clip = ClipLibrary::GetClip(file_name);
+
+	if(!clip)
 		return false;
-	}
 
-	if(scene->HasAnimations())
+	if(clip->tracks.size() > 0)
 	{
 		hasKeyframes = true;
 
-		aiAnimation* anim = scene->mAnimations[0];
-
-		/*printf ("animation name: %s\n", anim->mName.C_Str ());
-		printf ("animation has %i node channels\n", anim->mNumChannels);
-		printf ("animation has %i mesh channels\n", anim->mNumMeshChannels);
-		printf ("animation duration %f\n", anim->mDuration);
-		printf ("ticks per second %f\n", anim->mTicksPerSecond);*/
-
-		Animation* animation = new Animation(file_name, animations.size(), anim->mDuration);
-		///animationDuration = anim->mDuration;
-
-		//printf ("anim duration is %f\n", anim->mDuration);
-			
-		// get the node channels
-		for (int i = 0; i < (int)anim->mNumChannels; i++) 
-		{
-			aiNodeAnim* chan = anim->mChannels[i];
-			Bone* bone = GetBone(chan->mNodeName.C_Str()); //Grab the bone
-	
-			if (!bone) 
-			{
-				fprintf (stderr, "\nWARNING: did not find node named %s in skeleton."
-					"animation broken.\n", chan->mNodeName.C_Str ());
-				continue;
-			}
-
-			BoneAnimationData* boneAnimationData = new BoneAnimationData();
-			boneAnimationData->boneID = bone->id;
-
-			// add position keys to node
-			for (int i = 0; i < chan->mNumPositionKeys; i++) 
-			{
-				aiVectorKey key = chan->mPositionKeys[i];
-
-				PosKeyFrame* pkf = new PosKeyFrame;
-
-				pkf->position = glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z);
-				pkf->time = key.mTime; //TODO - check if time varies for each variable??
-
-				boneAnimationData->posKeyframes.push_back(pkf);
-			}
-
-			// add rotation keys to node
-			for (int i = 0; i < chan->mNumRotationKeys; i++) 
-			{
-				aiQuatKey key = chan->mRotationKeys[i];
-
-				RotKeyFrame* rkf = new RotKeyFrame;
-
-				rkf->rotation.x = key.mValue.x;
-				rkf->rotation.y = key.mValue.y;
-				rkf->rotation.z = key.mValue.z;
-				rkf->rotation.w = key.mValue.w;
+		//Shared with every other skeleton playing this clip on the same rig
+		const std::vector<int>* trackBoneIDs = ClipLibrary::GetBinding(clip, definition);
 
-				rkf->time = key.mTime;
+		animations.push_back(new Animation(clip, trackBoneIDs, animations.size()));
 
-				boneAnimationData->rotKeyframes.push_back(rkf);
-			}
-
-			// add scaling keys to node
-			//for (int i = 0; i < sn->num_sca_keys; i++) 
-			//{
-			//	aiVectorKey key = chan->mScalingKeys[i];
-			//	sn->sca_keys[i].v[0] = key.mValue.x;
-			//	sn->sca_keys[i].v[1] = key.mValue.y;
-			//	sn->sca_keys[i].v[2] = key.mValue.z;
-			//	sn->sca_key_times[i] = key.mTime;
-			//}
-
-			animation->animationData.push_back(boneAnimationData);
-		} 
-
-		animations.push_back(animation);
+		poseBuffer.Resize(GetNumBones(), std::max((int)animations.size(), MAX_ANIMATIONS)); //Done here so Animate never has to allocate
 	}
 	else 
 	{
 		fprintf (stderr, "WARNING: no animations found in mesh file\n");
 	}
 
-	aiReleaseImport (scene);
 	return true;
 }
-
-void Skeleton::PrintOuts(int winw, int winh)
-{
-	std::stringstream ss;
-	ss << "In queue: " << animationController.commandQueue.size();
-	drawText(20, 20, ss.str().c_str());
-
-	int amountActive = 0;
-
-	for(int i = 0; i < animations.size(); i++)
-	{
-		if(animations[i]->weight > 0)
-		{	
-			int offset = amountActive*120 + 40;
-			amountActive++;
-
-			std::stringstream ss;
-			ss << "AnimationID: " << animations[i]->animationID; 
-			drawText(20, 100 + offset, ss.str().c_str());
-
-			ss.str(std::string()); // clear
-			ss << "Duration: " << animations[i]->duration; 
-			drawText(20, 80 + offset, ss.str().c_str());
-
-			ss.str(std::string()); // clear
-			ss << "Frozen: " << animations[i]->frozen;
-			drawText(20, 60 + offset, ss.str().c_str());
-
-			ss.str(std::string()); // clear
-			ss << "LocalTimer: " << animations[i]->localClock; 
-			drawText(20, 40 + offset, ss.str().c_str());
-
-			ss.str(std::string()); // clear
-			ss << "Weight: " << animations[i]->weight;
-			drawText(20, 20 + offset, ss.str().c_str());
-		}
-	}
-
-	if(animationController.isBlending)
-	{
-		int offset = amountActive*120 + 40;
-
-		std::stringstream ss;
-		ss.str(std::string()); // clear
-		ss << "Blend Duration: " << animationController.blendDuration;
-		drawText(20, 60 + offset, ss.str().c_str());
-
-		ss.str(std::string()); // clear
-		ss << "Blend Timer: " << animationController.blendTimer;
-		drawText(20, 40 + offset, ss.str().c_str());
-
-		ss.str(std::string()); // clear
-		ss << "t: " << animationController.blendTimer / animationController.blendDuration;
-		drawText(20, 20 + offset, ss.str().c_str());
-	}
-
-
-}
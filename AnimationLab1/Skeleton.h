@@ -1,16 +1,10 @@
 #ifndef _SKELETON_H                // Prevent multiple definitions if this 
 #define _SKELETON_H                // file is included in more than one place
 
-#include <GL/glew.h>
-#include <GL/freeglut.h>
-
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <glm\gtx\quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
 
-#include <assimp/cimport.h> // C importer
-#include <assimp/scene.h> // collects data
-#include <assimp/postprocess.h> // various extra operations
 #include <assert.h>
 
 #include <vector>
@@ -19,22 +13,22 @@
 
 #include <iostream>
 
-#include "helper.h"
 #include "Bone.h"
 #include "Common.h"
 
 #include "Animation.h"
+#include "Pose.h"
+#include "AssetCache.h"
+#include "Inertialization.h"
+#include "AnimationLOD.h"
+#include "ClipLibrary.h"
+#include "SkeletonDefinition.h"
 
-class Model;
-
-struct Pose
-{
-	glm::vec3 translation;
-	glm::quat orientation;
-	float weight;
-};
+#define PARALLEL_BONE_THRESHOLD 256 //Rigs with at least this many bones blend their poses in parallel
+#define PARALLEL_BONE_GRAIN 64
 
-enum TransitionType { Smooth = 0, Immediate };
+//Smooth crossfades the two animations, Inertialized cuts to the new one and decays the difference away (see Inertialization.h)
+enum TransitionType { Smooth = 0, Immediate, Inertialized };
 
 struct AnimationCommand
 {
@@ -75,11 +69,17 @@ struct AnimationController
 
 	TransitionType transitionType;
 
+	//Set when an inertialized transition starts, for the skeleton to pick up
+	bool inertializationRequested;
+	float inertializationDuration;
+
 	std::queue<AnimationCommand> commandQueue; //FIFO
 
 	AnimationController()
 	{
 		isBlending = false;
+		inertializationRequested = false;
+		inertializationDuration = 0.0f;
 		blendTimer = 0.0;
 		blendDuration = 0.0;
 
@@ -139,6 +139,19 @@ struct AnimationController
 						current = command.animation;
 						current->Start(1, command.loop);
 					}
+					else if(transitionType == TransitionType::Inertialized)
+					{
+						if(current != 0)
+						{
+							current->Stop();
+
+							inertializationRequested = true;
+							inertializationDuration = command.blendDuration;
+						}
+
+						current = command.animation;
+						current->Start(1, command.loop);
+					}
 					else
 					{
 						if(current != 0)
@@ -170,41 +183,93 @@ class Skeleton
 {
 	private:
 		
-		Model* model;
-		
-		std::map<int, Bone*> bones;
-		std::map<std::string, int> boneNameToID;
-		std::vector<std::string> bonesAdded;
+		const SkeletonDefinition* definition; //The rig, shared with every other skeleton of the same mesh
 
 		std::vector<Animation*> animations;
 
+		PoseBuffer poseBuffer; //Poses sampled from the active animations, reused every frame
+
+		//This skeleton's pose, indexed by bone ID like the definition's arrays. Parents always come
+		//before their children, which is what lets UpdateGlobalTransforms be one pass over the arrays.
+		std::vector<glm::mat4> localTransforms;
+		std::vector<glm::mat4> globalTransforms;
+		std::vector<glm::mat4> finalTransforms; //What the shader skins with
+
+		std::vector<std::vector<float> > boneMasks; //A weight per bone ID for each mask
+
+		//The poses BlendPose produced the last two frames, and what's left of the last inertialized transition
+		std::vector<glm::vec3> lastTranslations;
+		std::vector<glm::quat> lastOrientations;
+		std::vector<glm::vec3> olderTranslations;
+		std::vector<glm::quat> olderOrientations;
+		std::vector<InertialBoneOffset> inertialOffsets;
+
+		bool inertializing;
+		bool beginInertialization; //Set for the first frame, when the offsets are measured
+		float inertializationTime;
+		float inertializationDuration;
+		float lastDeltaTime; //Seconds
+
+		int lodLevel;
+		int framesSinceUpdate;
+		double savedDeltaTime; //Time skipped frames have built up, in ms
+		bool cheapInterpolation; //Set from the LOD for the current Animate
+		std::vector<unsigned char> detailBones; //1 for bones distant LODs leave out
+
+		static int nextLODPhase; //Spreads out the frames throttled skeletons update on
+
 	public:
-		Bone* root;
 		AnimationController animationController;
 
 		bool hasKeyframes;
+		long lastAnimateAllocations; //Heap allocations made by the last call to Animate, should be 0
+		int lastBonesEvaluated; //Bones the last frame blended a pose for, 0 on frames the LOD skipped
 		std::map<std::string, std::vector<Bone*>> ikChains;
 
 		static bool ConstraintsEnabled;
 		static float AnimationSpeedScalar;
 
-		Skeleton(Model* myModel);
+
+		//Starts in the bind pose, the definition has to outlive the skeleton
+		Skeleton(const SkeletonDefinition* definition);
 		virtual ~Skeleton();
 
-		bool ImportAssimpBoneHierarchy(const aiScene* scene, aiNode* aiBone, Bone* parent, bool print = true);
 		void Animate(double deltaTime);
-		std::map<int, std::vector<Pose>> SampleKeyframes();
+
+		//Animate throttled by the LOD, returns false on frames it skipped so the caller can skip the transforms too
+		bool AnimateAtLOD(double deltaTime);
+		void SetLOD(int level) { lodLevel = glm::clamp(level, 0, NUM_ANIMATION_LODS - 1); }
+		int GetLOD() { return lodLevel; }
+
+		//Bones (and everything under them) too small to matter from a distance, e.g. fingers and face
+		void SetDetailBones(const char** boneNames, int count);
+		void SampleKeyframes();
+		void BlendPose(int boneIdx);
+
+		//A mask weighting the named bone and everything under it by weight and the rest of the skeleton by 0,
+		//returns its ID or -1 if there is no such bone
+		int CreateBoneMask(const std::string& boneName, float weight = 1.0f);
+
+		//How an animation combines with the others. Override weights are normalised per bone, so a masked
+		//layer at weight 3 over a base at weight 1 takes 75% of the bones it covers. Additive animations
+		//add their offset from their first frame on top, scaled by their weight.
+		void SetAnimationLayer(int index, BlendMode blendMode, int maskID = -1);
+
+		//Starts an animation outside the animation queue, for layers running alongside it
+		void PlayLayer(int index, float weight, bool loop = true) { if(index < animations.size()) animations[index]->Start(weight, loop); }
+		void StopLayer(int index) { if(index < animations.size()) animations[index]->Stop(); }
 
 		//void Control(bool *keyStates);
 		
-		bool ComputeIK(std::string chainName, glm::vec3 D, int steps);
+		//D is in world space, modelMatrix places the skeleton in the world
+		bool ComputeIK(std::string chainName, glm::vec3 D, int steps, const glm::mat4& modelMatrix);
 		void DefineIKChain(std::string name, std::vector<Bone*> chain);
 		void ImposeDOFRestrictions(Bone* bone);
 
-		void UpdateGlobalTransforms(Bone* bone, glm::mat4 parentTransform);
+		void UpdateGlobalTransforms(int firstBoneID = 0);
 
-		void PrintHeirarchy(Bone* root);
-		void PrintAiHeirarchy(aiNode* root);
+		glm::vec3 GetMeshSpacePosition(int boneID);
+		glm::vec3 GetEulerAngles(int boneID);
 
 		bool LoadAnimation(const char* file_name);
 
@@ -217,16 +282,35 @@ class Skeleton
 			}
 		}
 
-		void PrintOuts(int winw, int winh);
+		void PrintOuts(int winw, int winh); //Draws with GLUT, so it's in SkeletonPrintOuts.cpp with the game rather than the runtime
 
 		//Getters
-		std::map<int, Bone*> GetBones() { return bones; }
+		const SkeletonDefinition* GetDefinition() { return definition; }
+		const std::map<int, Bone*>& GetBones() { return definition->GetBones(); }
+		int GetNumBones() { return definition->GetNumBones(); }
+		std::vector<Animation*>& GetAnimations() { return animations; }
 		
-		Bone* GetBone(int id) { return bones[id]; }
-		Bone* GetBone(std::string name) { return bones[boneNameToID[name]]; }
-		Bone* operator [](int i) { return bones[i]; }
-
-		Bone* GetRootBone() { return root; }
+		Bone* GetBone(int id) { return definition->GetBone(id); }
+		Bone* GetBone(const char* name) { int id = definition->GetBoneID(name); return id >= 0 ? definition->GetBone(id) : 0; }
+		Bone* operator [](int i) { return definition->GetBone(i); }
+
+		//-1 if there is no such bone, see HashBoneName
+		int GetBoneID(const char* name) { return definition->GetBoneID(name); }
+		int FindBoneID(unsigned int nameHash, const char* name) { return definition->FindBoneID(nameHash, name); }
+
+		Bone* GetRootBone() { return definition->GetRootBone(); }
+
+		glm::mat4& GetLocalTransform(int id) { return localTransforms[id]; }
+		const glm::mat4& GetGlobalTransform(int id) { return globalTransforms[id]; }
+		const glm::mat4& GetFinalTransform(int id) { return finalTransforms[id]; }
+		const glm::mat4* GetFinalTransforms() { return finalTransforms.empty() ? 0 : &finalTransforms[0]; }
+		const std::vector<int>& GetParentIDs() { return definition->GetParentIDs(); }
+		const std::vector<glm::mat4>& GetOffsets() { return definition->GetOffsets(); }
+
+		//Mesh space, around every vertex as skinned with the current final transforms. Each bone's bind pose bounds are
+		//moved by its transform, so it's O(bones) rather than O(vertices), and conservative as long as each vertex's
+		//weights add up to one. Empty if the definition has no bone bounds.
+		BoundingBox GetSkinnedBounds();
 
 };
 
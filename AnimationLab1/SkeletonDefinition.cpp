@@ -0,0 +1,352 @@
+#include "SkeletonDefinition.h"
+
+#ifndef ANIMATION_NO_ASSIMP
+#include <assimp/scene.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+
+std::map<std::string, SkeletonDefinition*> SkeletonDefinition::definitions;
+
+SkeletonDefinition::SkeletonDefinition()
+{
+	root = nullptr;
+}
+
+SkeletonDefinition::~SkeletonDefinition()
+{
+	for(std::map<int, Bone*>::iterator it = bones.begin(); it != bones.end(); ++it)
+		delete it->second;
+
+	delete root; //The root isn't a bone so it's not in the map
+}
+
+const SkeletonDefinition* SkeletonDefinition::Get(const std::string& fileName, const std::string& rootName, const std::vector<BoneData>& hierarchy)
+{
+	std::map<std::string, SkeletonDefinition*>::iterator found = definitions.find(fileName);
+
+	if(found != definitions.end())
+		return found->second;
+
+	SkeletonDefinition* definition = new SkeletonDefinition;
+	definition->BuildHierarchy(rootName, hierarchy);
+
+	definitions[fileName] = definition;
+
+	return definition;
+}
+
+const SkeletonDefinition* SkeletonDefinition::Get(const std::string& fileName, const MeshData& mesh)
+{
+	SkeletonDefinition* definition = const_cast<SkeletonDefinition*>(Get(fileName, mesh.rootName, mesh.bones));
+
+	//The definition may have been made by something that only had the hierarchy
+	if(definition->boneBounds.empty())
+		definition->ComputeBoneBounds(mesh.positions, mesh.vertexWeights);
+
+	return definition;
+}
+
+void SkeletonDefinition::ComputeBoneBounds(const std::vector<glm::vec3>& positions, const std::vector<VertexWeight>& vertexWeights)
+{
+	boneBounds.assign(GetNumBones(), BoundingBox());
+
+	for(int vertex = 0; vertex < positions.size() && vertex < vertexWeights.size(); vertex++)
+	{
+		const VertexWeight& weight = vertexWeights[vertex];
+
+		for(int k = 0; k < NUM_WEIGHTS_PER_VERTEX; k++)
+		{
+			if(weight.weights[k] > 0.0f && weight.boneIDs[k] < boneBounds.size())
+				boneBounds[weight.boneIDs[k]].Add(positions[vertex]);
+		}
+	}
+}
+
+void SkeletonDefinition::Clear()
+{
+	for(std::map<std::string, SkeletonDefinition*>::iterator it = definitions.begin(); it != definitions.end(); ++it)
+		delete it->second;
+
+	definitions.clear();
+}
+
+#ifndef ANIMATION_NO_ASSIMP
+bool SkeletonDefinition::ImportAssimpBoneHierarchy(const aiScene* scene, bool print)
+{
+	//Every bone any mesh has, by name, so each node takes one lookup to check rather than a search through every mesh
+	std::unordered_map<std::string, const aiBone*> meshBones;
+
+	for(int meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++)
+	{
+		for(int boneIdx = 0; boneIdx < scene->mMeshes[meshIdx]->mNumBones; boneIdx++)
+		{
+			const aiBone* meshBone = scene->mMeshes[meshIdx]->mBones[boneIdx];
+			meshBones.insert(std::make_pair(std::string(meshBone->mName.data), meshBone)); //The first mesh with the bone gives its offset
+		}
+	}
+
+	ImportNode(scene->mRootNode, nullptr, meshBones, print);
+
+	return true;
+}
+
+void SkeletonDefinition::ImportNode(aiNode* node, Bone* parent, std::unordered_map<std::string, const aiBone*>& meshBones, bool print)
+{
+	Bone* bone = new Bone;
+	strcpy(bone->name, node->mName.data);
+
+	for (int i = 0; i < (int)node->mNumChildren; i++) 
+		ImportNode(node->mChildren[i], bone, meshBones, print); //depth first
+
+	if(print)
+	{
+		std::stringstream ss;
+		ss << "\n\nIs " << bone->name << " a bone?";
+		std::cout << ss.str();
+	}
+
+	std::unordered_map<std::string, const aiBone*>::iterator found = meshBones.find(bone->name);
+
+	if(found == meshBones.end()) //Is this node actually a bone?
+		return;
+
+	const aiBone* meshBone = found->second;
+	meshBones.erase(found); //So a second node of the same name isn't added too
+
+	bone->id = bones.size();
+	bones[bone->id] = bone;
+
+	bonesAdded.push_back(bone->name);
+
+	bone->parent = parent;
+	bone->parent->children.push_back(bone);
+	
+	//IDs are handed out in order, so these line up until FlattenHierarchy reorders them
+	offsets.push_back(convertAssimpMatrix(meshBone->mOffsetMatrix));
+	bindTransforms.push_back(convertAssimpMatrix(node->mTransformation));
+
+	root = bone->parent; //The last guy to get in here is the root, as it is depth first
+
+	bone->applyKeyframeFlag = false;
+
+	#pragma region PRINT OUT
+	if(print)
+	{
+		glm::vec3 offsetTranslation = decomposeT(offsets[bone->id]);
+		glm::vec3 mTransformTranslation = decomposeT(bindTransforms[bone->id]);
+
+		std::stringstream ss;
+		ss << "\nYES!";
+		ss << "\nbone->name: " << bone->name;
+		ss << "\nbone->parent: " << bone->parent->name;
+		ss << "\nnumberOfChildren: " << bone->children.size();
+		ss << "\nbone->offset: (x:" << offsetTranslation.x << ", y: " << offsetTranslation.y << ", z: " << offsetTranslation.z << ")";
+		ss << "\nmTransform: (x:" << mTransformTranslation.x << ", y: " << mTransformTranslation.y << ", z: " << mTransformTranslation.z << ")";
+		std::cout << ss.str();
+	}
+	#pragma endregion
+}
+#endif
+
+void SkeletonDefinition::GetHierarchy(std::string& rootName, std::vector<BoneData>& hierarchy) const
+{
+	rootName = root ? root->name : "";
+	hierarchy.resize(bones.size());
+
+	for(int boneID = 0; boneID < hierarchy.size(); boneID++)
+	{
+		BoneData& data = hierarchy[boneID];
+
+		data.name = bonesAdded[boneID];
+		data.parent = parentIDs[boneID];
+		data.offset = offsets[boneID];
+		data.transform = bindTransforms[boneID];
+	}
+}
+
+void SkeletonDefinition::BuildHierarchy(const std::string& rootName, const std::vector<BoneData>& hierarchy)
+{
+	root = new Bone;
+	strncpy(root->name, rootName.c_str(), sizeof(root->name) - 1);
+	root->name[sizeof(root->name) - 1] = '\0';
+
+	for(int i = 0; i < hierarchy.size(); i++)
+	{
+		Bone* bone = new Bone;
+		strncpy(bone->name, hierarchy[i].name.c_str(), sizeof(bone->name) - 1);
+		bone->name[sizeof(bone->name) - 1] = '\0';
+
+		bone->id = i;
+		bones[bone->id] = bone;
+
+		bonesAdded.push_back(bone->name);
+
+		offsets.push_back(hierarchy[i].offset);
+		bindTransforms.push_back(hierarchy[i].transform);
+
+		bone->applyKeyframeFlag = false;
+	}
+
+	for(int i = 0; i < hierarchy.size(); i++)
+	{
+		int parent = hierarchy[i].parent;
+
+		Bone* bone = bones[i];
+		bone->parent = parent >= 0 && parent < hierarchy.size() ? bones[parent] : root;
+		bone->parent->children.push_back(bone);
+	}
+
+	FlattenHierarchy(); //Should already be in order, but makes sure
+}
+
+void SkeletonDefinition::FlattenHierarchy()
+{
+	int numBones = bones.size();
+
+	//Anything whose parent isn't one of our bones hangs off the root
+	std::vector<Bone*> topLevel;
+	for(std::map<int, Bone*>::iterator it = bones.begin(); it != bones.end(); ++it)
+	{
+		Bone* parent = it->second->parent;
+		std::map<int, Bone*>::iterator found = parent ? bones.find(parent->id) : bones.end();
+
+		if(found == bones.end() || found->second != parent)
+			topLevel.push_back(it->second);
+	}
+
+	//Depth first, so every bone comes after its parent and each subtree is one contiguous run
+	std::vector<Bone*> order;
+	order.reserve(numBones);
+
+	std::vector<Bone*> stack(topLevel.rbegin(), topLevel.rend());
+	while(!stack.empty())
+	{
+		Bone* bone = stack.back();
+		stack.pop_back();
+
+		order.push_back(bone);
+
+		for(int i = bone->children.size() - 1; i >= 0; i--)
+			stack.push_back(bone->children[i]);
+	}
+
+	assert(order.size() == numBones);
+
+	//Renumber the bones in that order and move their matrices to match
+	std::vector<glm::mat4> oldOffsets;
+	std::vector<glm::mat4> oldBindTransforms;
+	oldOffsets.swap(offsets);
+	oldBindTransforms.swap(bindTransforms);
+
+	bones.clear();
+	bonesAdded.clear();
+
+	parentIDs.resize(numBones);
+	offsets.resize(numBones);
+	bindTransforms.resize(numBones);
+
+	for(int i = 0; i < numBones; i++)
+	{
+		Bone* bone = order[i];
+
+		offsets[i] = oldOffsets[bone->id];
+		bindTransforms[i] = oldBindTransforms[bone->id];
+
+		bone->id = i;
+		bones[i] = bone;
+
+		bonesAdded.push_back(bone->name);
+	}
+
+	//At most half full, so probe runs stay short
+	int tableSize = 16;
+	while(tableSize < numBones * 2)
+		tableSize *= 2;
+
+	nameTable.assign(tableSize, -1);
+	nameHashes.resize(numBones);
+
+	for(int i = 0; i < numBones; i++)
+	{
+		nameHashes[i] = HashBoneName(bonesAdded[i].c_str());
+
+		int slot = nameHashes[i] & (tableSize - 1);
+		while(nameTable[slot] >= 0)
+			slot = (slot + 1) & (tableSize - 1);
+
+		nameTable[slot] = i;
+	}
+
+	rigKey.clear();
+	for(int i = 0; i < numBones; i++)
+		rigKey += bonesAdded[i] + '/';
+
+	//Parents have their new IDs by now
+	for(int i = 0; i < numBones; i++)
+	{
+		Bone* parent = order[i]->parent;
+		std::map<int, Bone*>::iterator found = parent ? bones.find(parent->id) : bones.end();
+
+		parentIDs[i] = found != bones.end() && found->second == parent ? parent->id : -1;
+	}
+
+	bindTranslations.resize(numBones);
+	bindOrientations.resize(numBones);
+
+	for(int i = 0; i < numBones; i++)
+	{
+		bindTranslations[i] = glm::vec3(bindTransforms[i][3]);
+		bindOrientations[i] = glm::normalize(glm::quat_cast(glm::mat3(bindTransforms[i])));
+	}
+}
+
+int SkeletonDefinition::FindBoneID(unsigned int nameHash, const char* name) const
+{
+	if(nameTable.empty())
+		return -1;
+
+	int mask = nameTable.size() - 1;
+
+	for(int slot = nameHash & mask; nameTable[slot] >= 0; slot = (slot + 1) & mask)
+	{
+		int id = nameTable[slot];
+
+		if(nameHashes[id] == nameHash && bonesAdded[id] == name)
+			return id;
+	}
+
+	return -1;
+}
+
+#pragma region DEBUGGING PRINTOUTS
+void SkeletonDefinition::PrintHeirarchy(Bone* bone) const
+{
+	printf("\nbone->name: %s \n", bone->name);
+	printf("bone->parent: %i \n", bone->parent->name);
+
+	printf("numberOfChildren: %i \n", bone->children.size());
+
+	for(int i = 0; i < bone->children.size(); i++)
+		PrintHeirarchy(bone->children[i]);
+}
+
+#ifndef ANIMATION_NO_ASSIMP
+void SkeletonDefinition::PrintAiHeirarchy(aiNode* bone) const
+{
+	printf("\nbone->name: %s \n", bone->mName.C_Str());
+	printf("bone->parent: %i \n", bone->mParent->mName.C_Str());
+
+	printf("numberOfChildren: %i \n", bone->mNumChildren);
+
+	for(int i = 0; i < bone->mNumChildren; i++)
+		PrintAiHeirarchy(bone->mChildren[i]);
+}
+#endif
+#pragma endregion
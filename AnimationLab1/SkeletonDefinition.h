@@ -0,0 +1,116 @@
+#pragma once
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string>
+
+#include "Bone.h"
+#include "AssetCache.h"
+#include "Culling.h"
+
+struct aiScene;
+struct aiNode;
+struct aiBone;
+
+//FNV-1a of a bone name. Code that looks the same bone up every frame can hash its name once and use FindBoneID.
+inline unsigned int HashBoneName(const char* name)
+{
+	unsigned int hash = 2166136261u;
+
+	for(; *name; name++)
+		hash = (hash ^ (unsigned char)*name) * 16777619u;
+
+	return hash;
+}
+
+//Everything about a rig that doesn't change while it animates: the bones and their names, the hierarchy flattened
+//into arrays indexed by bone ID, the bind pose and the inverse bind (offset) matrices. Built once per mesh and shared
+//by every Skeleton of that mesh, which only keeps its own pose.
+class SkeletonDefinition
+{
+	private:
+
+		std::map<int, Bone*> bones;
+		Bone* root; //Not a bone, the node the top level bones hang off
+		std::vector<std::string> bonesAdded; //Names by bone ID
+
+		//Open addressed table of bone IDs by the hash of their name, -1 in empty slots. The size is a power of two.
+		std::vector<int> nameTable;
+		std::vector<unsigned int> nameHashes; //By bone ID
+		std::string rigKey; //The bone names in ID order, skeletons with the same one share clip bindings
+
+		//IDs are ordered so parents always come before their children
+		std::vector<int> parentIDs; //-1 for bones hanging off the root
+		std::vector<glm::mat4> offsets;
+		std::vector<glm::mat4> bindTransforms; //Local transforms of the bind pose
+
+		//The bind pose split up, for bones that only have additive poses to go on top of
+		std::vector<glm::vec3> bindTranslations;
+		std::vector<glm::quat> bindOrientations;
+
+		//Mesh space, around the bind pose vertices each bone has a weight on. Empty for bones that move no vertices.
+		std::vector<BoundingBox> boneBounds;
+
+		static std::map<std::string, SkeletonDefinition*> definitions; //Keyed by mesh path
+
+		void ImportNode(aiNode* node, Bone* parent, std::unordered_map<std::string, const aiBone*>& meshBones, bool print);
+
+	public:
+
+		SkeletonDefinition();
+		~SkeletonDefinition();
+
+		//One pass over the node tree, every node that one of the scene's meshes has a bone for becomes a bone
+		bool ImportAssimpBoneHierarchy(const aiScene* scene, bool print = true);
+
+		//Renumbers the bones parents first and fills in the flat arrays, call once the bones are in
+		void FlattenHierarchy();
+
+		//Fills in the per bone bounds from the bind pose positions and the weights on them, vertexWeights matching positions
+		void ComputeBoneBounds(const std::vector<glm::vec3>& positions, const std::vector<VertexWeight>& vertexWeights);
+
+		//For baking, BuildHierarchy recreates exactly the bones GetHierarchy saw
+		void GetHierarchy(std::string& rootName, std::vector<BoneData>& hierarchy) const;
+		void BuildHierarchy(const std::string& rootName, const std::vector<BoneData>& hierarchy);
+
+		//The definition for the mesh at fileName, built from hierarchy the first time it's asked for
+		static const SkeletonDefinition* Get(const std::string& fileName, const std::string& rootName, const std::vector<BoneData>& hierarchy);
+
+		//As above, also working out each bone's bounds from the mesh's weights if they aren't known yet
+		static const SkeletonDefinition* Get(const std::string& fileName, const MeshData& mesh);
+		static int GetNumDefinitions() { return definitions.size(); }
+
+		//Only once no skeleton is using any of them
+		static void Clear();
+
+		void PrintHeirarchy(Bone* root) const;
+		void PrintAiHeirarchy(aiNode* root) const;
+
+		//Getters
+		int GetNumBones() const { return bones.size(); }
+		const std::map<int, Bone*>& GetBones() const { return bones; }
+
+		//Bones hand out their joint limits for IK set up, those are part of the rig too
+		Bone* GetBone(int id) const { return bones.find(id)->second; }
+		Bone* GetRootBone() const { return root; }
+
+		//-1 if there is no such bone. Doesn't allocate.
+		int FindBoneID(unsigned int nameHash, const char* name) const;
+		int GetBoneID(const char* name) const { return FindBoneID(HashBoneName(name), name); }
+		int GetBoneID(const std::string& name) const { return GetBoneID(name.c_str()); }
+
+		const std::string& GetBoneName(int id) const { return bonesAdded[id]; }
+		const std::string& GetRigKey() const { return rigKey; }
+
+		const std::vector<int>& GetParentIDs() const { return parentIDs; }
+		const std::vector<glm::mat4>& GetOffsets() const { return offsets; }
+		const std::vector<glm::mat4>& GetBindTransforms() const { return bindTransforms; }
+		const std::vector<glm::vec3>& GetBindTranslations() const { return bindTranslations; }
+		const std::vector<glm::quat>& GetBindOrientations() const { return bindOrientations; }
+		const std::vector<BoundingBox>& GetBoneBounds() const { return boneBounds; }
+};
@@ -0,0 +1,66 @@
+#include "Skeleton.h"
+#include "Helper.h"
+
+#include <sstream>
+
+void Skeleton::PrintOuts(int winw, int winh)
+{
+	std::stringstream ss;
+	ss << "In queue: " << animationController.commandQueue.size();
+	drawText(20, 20, ss.str().c_str());
+
+	ss.str(std::string()); // clear
+	ss << "Animate allocations: " << lastAnimateAllocations;
+	drawText(20, 40, ss.str().c_str());
+
+	int amountActive = 0;
+
+	for(int i = 0; i < animations.size(); i++)
+	{
+		if(animations[i]->weight > 0)
+		{	
+			int offset = amountActive*120 + 40;
+			amountActive++;
+
+			std::stringstream ss;
+			ss << "AnimationID: " << animations[i]->animationID; 
+			drawText(20, 100 + offset, ss.str().c_str());
+
+			ss.str(std::string()); // clear
+			ss << "Duration: " << animations[i]->duration; 
+			drawText(20, 80 + offset, ss.str().c_str());
+
+			ss.str(std::string()); // clear
+			ss << "Frozen: " << animations[i]->frozen;
+			drawText(20, 60 + offset, ss.str().c_str());
+
+			ss.str(std::string()); // clear
+			ss << "LocalTimer: " << animations[i]->localClock; 
+			drawText(20, 40 + offset, ss.str().c_str());
+
+			ss.str(std::string()); // clear
+			ss << "Weight: " << animations[i]->weight;
+			drawText(20, 20 + offset, ss.str().c_str());
+		}
+	}
+
+	if(animationController.isBlending)
+	{
+		int offset = amountActive*120 + 40;
+
+		std::stringstream ss;
+		ss.str(std::string()); // clear
+		ss << "Blend Duration: " << animationController.blendDuration;
+		drawText(20, 60 + offset, ss.str().c_str());
+
+		ss.str(std::string()); // clear
+		ss << "Blend Timer: " << animationController.blendTimer;
+		drawText(20, 40 + offset, ss.str().c_str());
+
+		ss.str(std::string()); // clear
+		ss << "t: " << animationController.blendTimer / animationController.blendDuration;
+		drawText(20, 20 + offset, ss.str().c_str());
+	}
+
+
+}
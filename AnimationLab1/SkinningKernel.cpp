@@ -0,0 +1,226 @@
+#include "SkinningKernel.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SKINNING_X86
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE
+#define TARGET_AVX
+#else
+#include <cpuid.h>
+#define TARGET_SSE __attribute__((target("sse2")))
+#define TARGET_AVX __attribute__((target("avx")))
+#endif
+
+#endif
+
+#pragma region CPU detection
+
+#ifdef SKINNING_X86
+
+static void CPUID(int info[4], int function)
+{
+#ifdef _MSC_VER
+	__cpuid(info, function);
+#else
+	unsigned int a = 0, b = 0, c = 0, d = 0;
+	__get_cpuid(function, &a, &b, &c, &d);
+	info[0] = a; info[1] = b; info[2] = c; info[3] = d;
+#endif
+}
+
+//Which register states the OS saves on a context switch
+static unsigned long long XGETBV()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int low, high;
+	__asm__ __volatile__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return ((unsigned long long)high << 32) | low;
+#endif
+}
+
+#endif
+
+static SimdLevel DetectSimdLevel()
+{
+#ifdef SKINNING_X86
+	int info[4];
+	CPUID(info, 1);
+
+	bool sse2 = (info[3] & (1 << 26)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+
+	//AVX also needs the OS to save the ymm registers
+	if(avx && osxsave && (XGETBV() & 6) == 6)
+		return SimdAVX;
+
+	if(sse2)
+		return SimdSSE;
+#endif
+
+	return SimdScalar;
+}
+
+static SimdLevel supportedLevel = DetectSimdLevel();
+static SimdLevel activeLevel = supportedLevel;
+
+SimdLevel GetSupportedSimdLevel()
+{
+	return supportedLevel;
+}
+
+SimdLevel GetSimdLevel()
+{
+	return activeLevel;
+}
+
+void SetSimdLevel(SimdLevel level)
+{
+	activeLevel = level > supportedLevel ? supportedLevel : level;
+}
+
+const char* GetSimdLevelName(SimdLevel level)
+{
+	switch(level)
+	{
+		case SimdSSE: return "SSE";
+		case SimdAVX: return "AVX";
+		default: return "scalar";
+	}
+}
+
+#pragma endregion
+
+void ComposeTransforms(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* locals, int count)
+{
+	glm::vec3 unitScale(1.0f);
+
+	for(int i = 0; i < count; i++)
+		ComposeTransform(translations[i], rotations[i], scales ? scales[i] : unitScale, locals[i]);
+}
+
+#pragma region Matrix products
+
+//All three versions sum the columns in the same order as glm's operator*, so they give the same results
+
+static void ComputeSkinningMatricesScalar(const int* parentIDs, const glm::mat4* locals, const glm::mat4* offsets,
+	glm::mat4* globals, glm::mat4* finals, int firstBone, int count)
+{
+	for(int i = firstBone; i < count; i++)
+	{
+		int parentID = parentIDs[i];
+
+		globals[i] = parentID < 0 ? locals[i] : globals[parentID] * locals[i];
+		finals[i] = globals[i] * offsets[i];
+	}
+}
+
+#ifdef SKINNING_X86
+
+//out = a * b for column major a, b and out, out must not be a or b
+TARGET_SSE static inline void MultiplySSE(const float* a, const float* b, float* out)
+{
+	__m128 a0 = _mm_loadu_ps(a);
+	__m128 a1 = _mm_loadu_ps(a + 4);
+	__m128 a2 = _mm_loadu_ps(a + 8);
+	__m128 a3 = _mm_loadu_ps(a + 12);
+
+	for(int column = 0; column < 4; column++)
+	{
+		const float* bColumn = b + column * 4;
+
+		__m128 result = _mm_mul_ps(a0, _mm_set1_ps(bColumn[0]));
+		result = _mm_add_ps(result, _mm_mul_ps(a1, _mm_set1_ps(bColumn[1])));
+		result = _mm_add_ps(result, _mm_mul_ps(a2, _mm_set1_ps(bColumn[2])));
+		result = _mm_add_ps(result, _mm_mul_ps(a3, _mm_set1_ps(bColumn[3])));
+
+		_mm_storeu_ps(out + column * 4, result);
+	}
+}
+
+TARGET_SSE static void ComputeSkinningMatricesSSE(const int* parentIDs, const glm::mat4* locals, const glm::mat4* offsets,
+	glm::mat4* globals, glm::mat4* finals, int firstBone, int count)
+{
+	for(int i = firstBone; i < count; i++)
+	{
+		int parentID = parentIDs[i];
+
+		if(parentID < 0)
+			globals[i] = locals[i];
+		else
+			MultiplySSE(&globals[parentID][0][0], &locals[i][0][0], &globals[i][0][0]);
+
+		MultiplySSE(&globals[i][0][0], &offsets[i][0][0], &finals[i][0][0]);
+	}
+}
+
+//Same as MultiplySSE but two columns of the result at a time, a's columns are repeated in both halves
+//of the ymm registers and b's elements are broadcast within each half
+TARGET_AVX static inline void MultiplyAVX(const float* a, const float* b, float* out)
+{
+	__m256 a0 = _mm256_broadcast_ps((const __m128*)a);
+	__m256 a1 = _mm256_broadcast_ps((const __m128*)(a + 4));
+	__m256 a2 = _mm256_broadcast_ps((const __m128*)(a + 8));
+	__m256 a3 = _mm256_broadcast_ps((const __m128*)(a + 12));
+
+	for(int column = 0; column < 4; column += 2)
+	{
+		__m256 bColumns = _mm256_loadu_ps(b + column * 4);
+
+		__m256 result = _mm256_mul_ps(a0, _mm256_permute_ps(bColumns, 0x00));
+		result = _mm256_add_ps(result, _mm256_mul_ps(a1, _mm256_permute_ps(bColumns, 0x55)));
+		result = _mm256_add_ps(result, _mm256_mul_ps(a2, _mm256_permute_ps(bColumns, 0xAA)));
+		result = _mm256_add_ps(result, _mm256_mul_ps(a3, _mm256_permute_ps(bColumns, 0xFF)));
+
+		_mm256_storeu_ps(out + column * 4, result);
+	}
+}
+
+TARGET_AVX static void ComputeSkinningMatricesAVX(const int* parentIDs, const glm::mat4* locals, const glm::mat4* offsets,
+	glm::mat4* globals, glm::mat4* finals, int firstBone, int count)
+{
+	for(int i = firstBone; i < count; i++)
+	{
+		int parentID = parentIDs[i];
+
+		if(parentID < 0)
+			globals[i] = locals[i];
+		else
+			MultiplyAVX(&globals[parentID][0][0], &locals[i][0][0], &globals[i][0][0]);
+
+		MultiplyAVX(&globals[i][0][0], &offsets[i][0][0], &finals[i][0][0]);
+	}
+
+	//Avoid the penalty for switching back to SSE code with the upper halves dirty
+	_mm256_zeroupper();
+}
+
+#endif
+
+void ComputeSkinningMatrices(const int* parentIDs, const glm::mat4* locals, const glm::mat4* offsets,
+	glm::mat4* globals, glm::mat4* finals, int firstBone, int count)
+{
+#ifdef SKINNING_X86
+	if(activeLevel == SimdAVX)
+	{
+		ComputeSkinningMatricesAVX(parentIDs, locals, offsets, globals, finals, firstBone, count);
+		return;
+	}
+
+	if(activeLevel == SimdSSE)
+	{
+		ComputeSkinningMatricesSSE(parentIDs, locals, offsets, globals, finals, firstBone, count);
+		return;
+	}
+#endif
+
+	ComputeSkinningMatricesScalar(parentIDs, locals, offsets, globals, finals, firstBone, count);
+}
+
+#pragma endregion
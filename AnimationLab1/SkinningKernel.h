@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+//Batch kernels for turning a pose into skinning matrices. The matrix products have SSE and AVX versions,
+//the fastest one the CPU supports is picked the first time they are used.
+
+enum SimdLevel { SimdScalar = 0, SimdSSE, SimdAVX };
+
+SimdLevel GetSupportedSimdLevel();
+SimdLevel GetSimdLevel();
+void SetSimdLevel(SimdLevel level); //Clamped to what the CPU supports, for benchmarking
+const char* GetSimdLevelName(SimdLevel level);
+
+//Translation * rotation * scale without multiplying any matrices, gives the same result as
+//glm::translate(glm::mat4(1), translation) * glm::toMat4(rotation) * glm::scale(glm::mat4(1), scale)
+inline void ComposeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& out)
+{
+	float qxx = rotation.x * rotation.x;
+	float qyy = rotation.y * rotation.y;
+	float qzz = rotation.z * rotation.z;
+	float qxz = rotation.x * rotation.z;
+	float qxy = rotation.x * rotation.y;
+	float qyz = rotation.y * rotation.z;
+	float qwx = rotation.w * rotation.x;
+	float qwy = rotation.w * rotation.y;
+	float qwz = rotation.w * rotation.z;
+
+	out[0][0] = (1.0f - 2.0f * (qyy + qzz)) * scale.x;
+	out[0][1] = (2.0f * (qxy + qwz)) * scale.x;
+	out[0][2] = (2.0f * (qxz - qwy)) * scale.x;
+	out[0][3] = 0.0f;
+
+	out[1][0] = (2.0f * (qxy - qwz)) * scale.y;
+	out[1][1] = (1.0f - 2.0f * (qxx + qzz)) * scale.y;
+	out[1][2] = (2.0f * (qyz + qwx)) * scale.y;
+	out[1][3] = 0.0f;
+
+	out[2][0] = (2.0f * (qxz + qwy)) * scale.z;
+	out[2][1] = (2.0f * (qyz - qwx)) * scale.z;
+	out[2][2] = (1.0f - 2.0f * (qxx + qyy)) * scale.z;
+	out[2][3] = 0.0f;
+
+	out[3][0] = translation.x;
+	out[3][1] = translation.y;
+	out[3][2] = translation.z;
+	out[3][3] = 1.0f;
+}
+
+//Local transforms for count bones, scales can be null for unit scale
+void ComposeTransforms(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, glm::mat4* locals, int count);
+
+//globals[i] = globals[parentIDs[i]] * locals[i] (just locals[i] for a parent of -1) and finals[i] = globals[i] * offsets[i],
+//for bones firstBone to count - 1. Parents have to come before their children.
+void ComputeSkinningMatrices(const int* parentIDs, const glm::mat4* locals, const glm::mat4* offsets,
+	glm::mat4* globals, glm::mat4* finals, int firstBone, int count);
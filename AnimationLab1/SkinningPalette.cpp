@@ -0,0 +1,110 @@
+#include "SkinningPalette.h"
+#include "ShaderManager.h"
+
+#include <stdio.h>
+#include <string.h>
+
+SkinningPalette::SkinningPalette()
+{
+	buffer = 0;
+	texture = 0;
+	regionSize = 0;
+	region = 0;
+
+	for(int i = 0; i < PALETTE_REGIONS; i++)
+		fences[i] = 0;
+}
+
+int SkinningPalette::Add(const glm::mat4* transforms, int count)
+{
+	int offset = matrices.size();
+
+	if(transforms)
+		matrices.insert(matrices.end(), transforms, transforms + count);
+
+	return offset;
+}
+
+void SkinningPalette::Grow(int size)
+{
+	while(regionSize < size)
+		regionSize = regionSize > 0 ? regionSize * 2 : PALETTE_MIN_REGION_SIZE;
+
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	PROFILE_COUNT(ShaderManager::GLQueries, 1);
+
+	if(regionSize * PALETTE_REGIONS * 4 > maxTexels)
+		fprintf(stderr, "The skinning palette needs %i texels, more than the %i buffer textures can have\n", regionSize * PALETTE_REGIONS * 4, maxTexels);
+
+	if(buffer == 0)
+	{
+		glGenBuffers(1, &buffer);
+		glGenTextures(1, &texture);
+	}
+
+	//New storage, so the old fences don't guard anything any more
+	for(int i = 0; i < PALETTE_REGIONS; i++)
+	{
+		if(fences[i])
+			glDeleteSync(fences[i]);
+
+		fences[i] = 0;
+	}
+
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	glBufferData(GL_TEXTURE_BUFFER, regionSize * PALETTE_REGIONS * sizeof(glm::mat4), 0, GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	//Each matrix is four texels, one per column
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void SkinningPalette::Upload()
+{
+	if(matrices.empty())
+		return;
+
+	if(matrices.size() > regionSize)
+		Grow(matrices.size());
+
+	region = (region + 1) % PALETTE_REGIONS;
+
+	if(fences[region])
+	{
+		glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); //ns, only waits if the GPU is PALETTE_REGIONS frames behind
+		glDeleteSync(fences[region]);
+		fences[region] = 0;
+	}
+
+	//The fence says nothing is reading this region, so the driver needn't check either
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+	void* data = glMapBufferRange(GL_TEXTURE_BUFFER, GetRegionStart() * sizeof(glm::mat4), matrices.size() * sizeof(glm::mat4),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+	if(data)
+	{
+		memcpy(data, &matrices[0], matrices.size() * sizeof(glm::mat4));
+		glUnmapBuffer(GL_TEXTURE_BUFFER);
+	}
+	else
+	{
+		fprintf(stderr, "Couldn't map the skinning palette\n");
+	}
+
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glActiveTexture(GL_TEXTURE0 + PALETTE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void SkinningPalette::EndFrame()
+{
+	if(matrices.empty() || fences[region])
+		return;
+
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
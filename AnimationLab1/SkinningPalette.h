@@ -0,0 +1,53 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "Common.h"
+
+#define PALETTE_REGIONS 3 //Frames the GPU can fall behind before a write has to wait for it
+#define PALETTE_MIN_REGION_SIZE 256 //Matrices
+
+//Every skinned model's bone matrices for a frame, packed into one buffer and uploaded with a single write. Shaders read
+//it as a buffer texture (see Shaders/skinned.vs), each model from its own offset, so there's no limit on bones per model.
+//The buffer is split into regions used a frame at a time, and a fence on each means a region is only written
+//again once the GPU has finished drawing from it.
+class SkinningPalette
+{
+	private:
+
+		std::vector<glm::mat4> matrices; //This frame's, in the order they were added
+
+		GLuint buffer;
+		GLuint texture;
+
+		int regionSize; //Matrices
+		int region; //Being drawn from this frame
+		GLsync fences[PALETTE_REGIONS];
+
+		void Grow(int size);
+
+	public:
+
+		SkinningPalette();
+
+		//Empties the palette for a new frame
+		void Begin() { matrices.clear(); }
+
+		//Copies count matrices in, returns where they start for Upload's region
+		int Add(const glm::mat4* transforms, int count);
+
+		//Writes the frame's matrices to the next region and binds the buffer texture to PALETTE_TEXTURE_UNIT.
+		//Call after the last Add and before anything skinned is drawn.
+		void Upload();
+
+		//Call once the frame's draws have been issued, so the region isn't reused before the GPU is done with it
+		void EndFrame();
+
+		//What to add to the offsets Add gave, for the shader's paletteOffset
+		int GetRegionStart() { return region * regionSize; }
+		int GetNumMatrices() { return matrices.size(); }
+};
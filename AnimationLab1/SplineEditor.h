@@ -1,5 +1,7 @@
 #pragma once
 
+#include <GL/freeglut.h>
+
 #include "Model.h"
 #include "Helper.h"
 #include "Common.h"
@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <chrono>
+#endif
+
+//High resolution stopwatch for benchmarks and profiling
+class Timer
+{
+	private:
+
+#ifdef _WIN32
+		LARGE_INTEGER start;
+		LARGE_INTEGER frequency;
+#else
+		std::chrono::high_resolution_clock::time_point start;
+#endif
+
+	public:
+
+		Timer()
+		{
+#ifdef _WIN32
+			QueryPerformanceFrequency(&frequency);
+#endif
+			Reset();
+		}
+
+		void Reset()
+		{
+#ifdef _WIN32
+			QueryPerformanceCounter(&start);
+#else
+			start = std::chrono::high_resolution_clock::now();
+#endif
+		}
+
+		double ElapsedMilliseconds()
+		{
+#ifdef _WIN32
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			return double(now.QuadPart - start.QuadPart) * 1000.0 / double(frequency.QuadPart);
+#else
+			return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+#endif
+		}
+};
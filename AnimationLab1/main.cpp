@@ -21,6 +21,15 @@
 #include "Common.h"
 #include "Keys.h"
 #include "Gamepad.h"
+#include "Benchmark.h"
+#include "AssetCache.h"
+#include "JobSystem.h"
+#include "FixedTimestep.h"
+#include "Profiler.h"
+#include "SkinningPalette.h"
+#include "RenderQueue.h"
+#include "Culling.h"
+#include "Simulation.h"
 
 #include <string> 
 #include <fstream>
@@ -48,16 +57,14 @@ void gamepad(unsigned int buttonMask, int x, int y, int z);
 
 void reshape(int w, int h);
 void update();
+void simulateWithEditors(double stepTime);
 void draw();
 
 bool directionKeys[4] = {false};
 
-bool keyStates[256] = {false}; // Create an array of boolean values of length 256 (0-255)
-
 void processContinuousInput();
 void printouts();
 
-Camera camera;
 glm::mat4 projectionMatrix; // Store the projection matrix
 bool freeMouse = false;
 
@@ -70,16 +77,15 @@ int WINDOW_HEIGHT = 720;
 //int WINDOW_WIDTH = 1680;
 //int WINDOW_HEIGHT = 1050;
 
-int oldTimeSinceStart;
-double deltaTime;
+double deltaTime; //Of the frame, ms
+float renderInterpolation; //How far between the last two simulation steps the frame is drawn
 
 int fps = 0;
-int frameCounterTime = 0;
+double frameCounterTime = 0.0; //ms
 int frames = 0;
 //char *text;
 
 ShaderManager shaderManager;
-vector<Model*> objectList;
 
 LevelEditor* levelEditor;
 SplineEditor* splineEditor;
@@ -87,20 +93,57 @@ SplineEditor* splineEditor;
 short editMode = 0;
 enum EditMode { off = 0, levelEdit, splineEdit };
 
-Player* player;
 bool moveFix = false;
 
-NPC* donald;
-
 bool printText = false;
 
-Spline cameraSpline;
-Spline cactuarSpline;
-
 Gamepad* xgamepad;
 
+SkinningPalette skinningPalette;
+GLuint textShaderProgramID = 0; //Kept so draw doesn't look it up by name every frame
+RenderQueue renderQueue; //Refilled every frame, kept around so it doesn't reallocate
+vector<int> paletteOffsets; //Where each object's bones are in the palette, by index into objectList
+
+CullingBatch cullingBatch; //Refilled every frame like renderQueue
+vector<int> cullingIndices; //Each object's sphere in cullingBatch, -1 for ones with no bounds, which are always drawn
+vector<glm::mat4> modelMatrices; //Each object's interpolated model matrix this frame
+int objectsVisible = 0;
+int objectsCulled = 0;
+
+//Skins the characters on the CPU and checks them against the reference, for machines without a GPU
+bool cpuSkinningCheck()
+{
+	vector<const char*> soraAnimations;
+	soraAnimations.push_back("Animations/sora_idle_accad_female_look.dae");
+	soraAnimations.push_back("Animations/sora_brisk_walk.dae");
+	soraAnimations.push_back("Animations/sora_punch_cmu_02_05.dae");
+
+	vector<const char*> donaldAnimations;
+	donaldAnimations.push_back("Animations/don_walk.dae");
+	donaldAnimations.push_back("Animations/don_wave.dae");
+	donaldAnimations.push_back("Animations/don_angry_talk_cmu_79_74.dae");
+	donaldAnimations.push_back("Animations/don_happy_talk_cmu_happy.dae");
+
+	bool soraPassed = Benchmark::CpuSkinning("Models/sora.dae", soraAnimations);
+	bool donaldPassed = Benchmark::CpuSkinning("Models/don1.dae", donaldAnimations);
+
+	return soraPassed && donaldPassed;
+}
+
 int main(int argc, char** argv)
 {
+	//Offline baking doesn't need a window, -bake only rebakes what changed, -bake -force rebakes everything
+	if(argc > 1 && strcmp(argv[1], "-bake") == 0)
+		return AssetCache::BakeAll(argc > 2 && strcmp(argv[2], "-force") == 0) == 0 ? 0 : 1;
+
+	//Neither does skinning on the CPU
+	if(argc > 1 && strcmp(argv[1], "-cpuskin") == 0)
+		return cpuSkinningCheck() ? 0 : 1;
+
+	//Or simulating the game, -headless 10000 runs that many steps, -headless 10000 -cpuskinning skins the characters too
+	if(argc > 1 && strcmp(argv[1], "-headless") == 0)
+		return runHeadless(argc > 2 ? atoi(argv[2]) : 3600, argc > 3 && strcmp(argv[3], "-cpuskinning") == 0);
+
 	// Set up the window
 	glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE|GLUT_RGB|GLUT_DEPTH);
@@ -154,6 +197,9 @@ int main(int argc, char** argv)
 
 	xgamepad = new Gamepad();
 
+	jobSystem = new JobSystem();
+	jobSystem->Init();
+
 	levelEditor = new LevelEditor(&objectList);
 
 	shaderManager.Init();
@@ -165,15 +211,21 @@ int main(int argc, char** argv)
 	shaderManager.CreateShaderProgram("white", "Shaders/diffuse.vs", "Shaders/white.ps");
 	shaderManager.CreateShaderProgram("red", "Shaders/diffuse.vs", "Shaders/red.ps");
 
-	shaderManager.CreateShaderProgram("text", "Shaders/diffuse.vs", "Shaders/black.ps");
+	textShaderProgramID = shaderManager.CreateShaderProgram("text", "Shaders/diffuse.vs", "Shaders/black.ps");
 
-	Node::objectList = &objectList;
+	if(!loadScene(xgamepad))
+		return 1;
 
-	vector<Model*> loadedObjects = LevelEditor::Load(8);
-	objectList.insert(objectList.end(), loadedObjects.begin(), loadedObjects.end());
-	
-	player = new Player(objectList, &camera, xgamepad, new Model(glm::vec3(15,0,0), glm::mat4(1), glm::vec3(.6), "Models/sora.dae", shaderManager.GetShaderProgramID("skinned"), false)); 
-	donald = new NPC(objectList, new Model(glm::vec3(5,0,0), glm::mat4(1), glm::vec3(.1), "Models/don1.dae", shaderManager.GetShaderProgramID("skinned"), false), player);
+	if(argc > 1 && strcmp(argv[1], "-benchmark") == 0)
+	{
+		std::vector<Skeleton*> skeletons;
+		skeletons.push_back(player->model->GetSkeleton());
+		skeletons.push_back(donald->model->GetSkeleton());
+
+		Benchmark::Run(skeletons);
+		cpuSkinningCheck();
+		return 0;
+	}
 
 	//objectList.push_back(new Model(glm::vec3(0,0,0), glm::mat4(1), glm::vec3(.0001), "Models/jumbo.dae", shaderManager.GetShaderProgramID("diffuse")));
 	//objectList.push_back(new Model(glm::vec3(0,0,0), glm::mat4(1), glm::vec3(.001), "Models/crate.dae", shaderManager.GetShaderProgramID("diffuse")));
@@ -229,23 +281,6 @@ int main(int argc, char** argv)
 	splineEditor = new SplineEditor(&camera);
 	splineEditor->spline.SetMode(InterpolationMode::Cubic);
 
-	cameraSpline.SetSpeed(10.0f);
-	cameraSpline.Load(2, false);
-	cameraSpline.constantSpeed = true;
-
-	Spline donaldSpline;
-	donaldSpline.SetSpeed(3.0f);
-	donaldSpline.Load(11, false);
-	donaldSpline.constantSpeed = true;
-	donaldSpline.mode = InterpolationMode::Cubic;
-
-	donald->patrol = donaldSpline;
-	donald->patrolling = true;
-
-	cactuarSpline.mode = InterpolationMode::None;
-	cactuarSpline.Load(25, false);
-	cactuarSpline.SetSpeed(2.0f);
-
 	glutMainLoop();
     
 	return 0;
@@ -254,10 +289,11 @@ int main(int argc, char** argv)
 // GLUT CALLBACK FUNCTIONS
 void update()
 {
-	//Calculate deltaTime
-	int timeSinceStart = glutGet(GLUT_ELAPSED_TIME);
-    deltaTime = timeSinceStart - oldTimeSinceStart;
-    oldTimeSinceStart = timeSinceStart;
+	Profiler::EndFrame();
+
+	//Input, the camera and drawing run every frame, the game runs in fixed steps in between
+	deltaTime = scheduler.Advance(simulateWithEditors);
+	renderInterpolation = scheduler.GetInterpolation();
 
 	//Calculate fps
 	frames++;
@@ -265,47 +301,17 @@ void update()
 	if(frameCounterTime > 1000)
 	{
 		fps = frames;
-		frames = frameCounterTime = 0;
+		frames = 0;
+		frameCounterTime = 0.0;
 	}
 
-	camera.Update(deltaTime);
-	player->Update(deltaTime);
-	donald->Update(deltaTime); //TODO - make a character class with functions for update / input etc.
+	//Follow where the player is drawn, not where the last step left them
+	if(camera.mode == CameraMode::tp)
+		camera.SetTarget(player->model->GetTranslation(renderInterpolation));
 
-	
-	for(int i = 0; i< objectList.size(); i++)
 	{
-		//Animation
-		if(objectList[i]->HasSkeleton())
-		{
-			//TODO - If animationMode == IK .. and so on
-			//	if(objectList[i]->GetSkeleton()->ikChains.size() > 0)
-			//		objectList[i]->GetSkeleton()->ComputeIK("chain1", /*glm::vec3(0,5,0)*/target->worldProperties.translation, 50); //replace with iteration, ikchain should be a struct with a target?
-			//																											//if no target do nothing?
-
-			if(objectList[i]->GetSkeleton()->hasKeyframes)
-				objectList[i]->GetSkeleton()->Animate(deltaTime); //this overwrites control above
-			
-			objectList[i]->GetSkeleton()->UpdateGlobalTransforms(objectList[i]->GetSkeleton()->GetRootBone(), glm::mat4());
-		}
-
-		objectList[i]->Update(deltaTime);
-	}
-
-	/*if(objectList.size() == 2)
-		objectList[0]->worldProperties.orientation *= glm::toMat4(glm::angleAxis(1.0f, glm::vec3(0,1,0)));*/
-
-	//FOR ITERATING SUBCHAINS
-	//std::map<char,int>::iterator it;
-	//for (std::map<char,int>::iterator it=mymap.begin(); it!=mymap.end(); ++it)
-	//std::cout << it->first << " => " << it->second << '\n';
-
-	if(editMode == EditMode::splineEdit)
-	{
-		splineEditor->spline.Update(deltaTime);
-
-		if(splineEditor->spline.nodes.size() > 0)
-			splineEditor->tester->worldProperties.translation = splineEditor->spline.GetPosition();
+		PROFILE_SCOPE("camera.Update");
+		camera.Update(deltaTime);
 	}
 
 	if(camera.mode == CameraMode::path)
@@ -315,40 +321,23 @@ void update()
 
 		camera.SetTarget(glm::vec3(0,0,0));
 	}
+		
+	processContinuousInput();
+	draw();
+}
 
-	cactuarSpline.Update(deltaTime);
+//The game's step, and the spline editor's, which only the windowed game has
+void simulateWithEditors(double stepTime)
+{
+	simulate(stepTime);
 
-	if(!donald->questComplete)
+	if(editMode == EditMode::splineEdit)
 	{
-		bool check = false;
-		for(int i = 0; i < objectList.size(); i++)
-		{
-			if(objectList[i]->GetFileName() == "Models/jumbo.dae")//TODO make a cactuar class
-			{
-				if(objectList[i]->drawMe)
-				{
-					check = true;
-
-					objectList[i]->worldProperties.translation.y = cactuarSpline.GetPosition().y;
-
-					if(player->GetState() == 2)
-					{
-						if(glm::distance(player->model->worldProperties.translation, objectList[i]->worldProperties.translation) < 2.5)
-						{
-							objectList[i]->die = true;
-						}
-					}
-				}
-			}
-		}
+		splineEditor->spline.Update(stepTime);
 
-		if(check == false)
-			donald->questComplete = true;
+		if(splineEditor->spline.nodes.size() > 0)
+			splineEditor->tester->worldProperties.translation = splineEditor->spline.GetPosition();
 	}
-
-		
-	processContinuousInput();
-	draw();
 }
 
 void CactuarDeathAnimation()
@@ -356,61 +345,103 @@ void CactuarDeathAnimation()
 
 }
 
+//Whether the object is drawn this frame, only right once draw has culled
+bool IsDrawn(int object)
+{
+	return objectList[object]->drawMe && (cullingIndices[object] < 0 || cullingBatch.IsVisible(cullingIndices[object]));
+}
+
 //Draw loops through each 3d object, and switches to the correct shader for that object, and fill the uniform matrices with the up-to-date values,
 //before finally binding the VAO and drawing with verts or indices
 void draw()
 {
+	PROFILE_SCOPE("draw");
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 	//glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
 
 	glm::mat4 viewMatrix = camera.GetViewMatrix();
+	glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
 
-	for(int i = 0; i < objectList.size(); i++)
+	//Whatever is wholly outside the view isn't queued. Skinned models go by the bounds of their current pose.
 	{
-		if(objectList[i]->drawMe)
+		PROFILE_SCOPE("cull");
+
+		cullingBatch.Clear();
+		cullingIndices.resize(objectList.size());
+		modelMatrices.resize(objectList.size());
+
+		for(int i = 0; i < objectList.size(); i++)
 		{
-			//Set shader
-			shaderManager.SetShaderProgram(objectList[i]->GetShaderProgramID());
+			cullingIndices[i] = -1;
 
-			//Set MVP matrix
-			glm::mat4 MVP = projectionMatrix * viewMatrix * objectList.at(i)->GetModelMatrix();
-			int mvpMatrixLocation = glGetUniformLocation(objectList[i]->GetShaderProgramID(), "mvpMatrix"); // Get the location of mvp matrix in the shader
-			glUniformMatrix4fv(mvpMatrixLocation, 1, GL_FALSE, glm::value_ptr(MVP)); // Send updated mvp matrix 
-		
-			//Set Bone matrices
-			if(objectList[i]->HasSkeleton())
+			if(!objectList[i]->drawMe)
+				continue;
+
+			modelMatrices[i] = objectList[i]->GetModelMatrix(renderInterpolation);
+
+			BoundingBox bounds = objectList[i]->GetPosedBounds();
+
+			if(!bounds.IsEmpty())
+				cullingIndices[i] = cullingBatch.Add(BoundingSphere(TransformBox(bounds, modelMatrices[i])));
+		}
+
+		cullingBatch.Cull(Frustum::FromMatrix(viewProjectionMatrix));
+
+		objectsCulled = cullingBatch.GetNumCulled();
+		objectsVisible = 0;
+
+		for(int i = 0; i < objectList.size(); i++)
+		{
+			if(IsDrawn(i))
+				objectsVisible++;
+		}
+	}
+
+	//Every skinned model's bones go up together, before anything is drawn
+	{
+		PROFILE_SCOPE("upload palette");
+
+		skinningPalette.Begin();
+		paletteOffsets.resize(objectList.size());
+
+		for(int i = 0; i < objectList.size(); i++)
+		{
+			if(IsDrawn(i) && objectList[i]->HasSkeleton())
 			{
-				glm::mat4 boneMatrices[MAX_BONES];
-				int boneMatricesAttribLocations[MAX_BONES]; //INVESTIGATE - does this really need to be done every frame?
-
-				for(int j = 0; j < MAX_BONES; j++)
-					boneMatrices[j] = glm::mat4(1);
-
-				//objectList[i]->GetSkeleton()->UpdateGlobalTransforms(objectList[i]->GetSkeleton()->GetRootBone(), glm::mat4());
-
-				int numBones = objectList[i]->GetSkeleton()->GetBones().size();
-				for(int boneidx = 0; boneidx < numBones; boneidx++)
-				{
-					Bone* bone = objectList[i]->GetSkeleton()->GetBone(boneidx);
-					boneMatrices[bone->id] = bone->finalTransform;
-				}
-
-				//Send up-to-date bone matrix data to the shader 
-				for(int j = 0; j < MAX_BONES; j++)
-				{
-					stringstream ss;
-					ss << "boneMatrices[" << j << "]";
-					boneMatricesAttribLocations[j] = glGetUniformLocation (objectList[i]->GetShaderProgramID(), ss.str().c_str()); //Get location of bone matrix in shader
-					glUniformMatrix4fv (boneMatricesAttribLocations[j], numBones, GL_FALSE, glm::value_ptr(boneMatrices[j])); //send updated matrix
-				}
+				Skeleton* skeleton = objectList[i]->GetSkeleton();
+				paletteOffsets[i] = skinningPalette.Add(skeleton->GetFinalTransforms(), skeleton->GetNumBones());
 			}
+		}
+
+		skinningPalette.Upload();
+	}
+
+	//Collected up and sorted by the state they need, so models sharing a shader or texture are drawn together
+	{
+		PROFILE_SCOPE("queue draws");
+
+		renderQueue.Clear();
 
-			//Render
-			objectList.at(i)->Render(shaderManager.GetCurrentShaderProgramID());
+		for(int i = 0; i < objectList.size(); i++)
+		{
+			if(IsDrawn(i))
+			{
+				glm::mat4 MVP = viewProjectionMatrix * modelMatrices[i];
+				int paletteOffset = objectList[i]->HasSkeleton() ? skinningPalette.GetRegionStart() + paletteOffsets[i] : -1;
+
+				objectList[i]->QueueDraws(renderQueue, renderQueue.AddMatrix(MVP), paletteOffset);
+			}
 		}
-	}	
 
-	shaderManager.SetShaderProgram(shaderManager.GetShaderProgramID("text"));
+		renderQueue.Sort();
+	}
+
+	renderQueue.Submit();
+
+	skinningPalette.EndFrame();
+
+	shaderManager.SetShaderProgram(textShaderProgramID);
 
 	if(donald->dialogue.size() > 0)
 		dialogue(WINDOW_WIDTH/2-(strlen(donald->dialogue.c_str())*4), 80, donald->dialogue.c_str());
@@ -418,6 +449,7 @@ void draw()
 	if(printText)
 		printouts();
 
+	PROFILE_SCOPE("glutSwapBuffers");
 	glutSwapBuffers();
 }
 
@@ -516,7 +548,6 @@ void processContinuousInput()
 		AnimationController::blendScalar = 1.0f;
 
 	camera.ProcessKeyboardContinuous(keyStates, deltaTime);
-	player->ProcessKeyboardContinuous(keyStates, deltaTime);
 }
 
 //DIRECTIONAL KEYS DOWN
@@ -539,6 +570,10 @@ void handleSpecialKeypress(int key, int x, int y)
 		case GLUT_KEY_DOWN:
 			directionKeys[DKEY::Down] = true;
 			break;
+
+		case GLUT_KEY_F9:
+			Profiler::ExportChromeTrace("profile.json");
+			break;
 	}
 
 	if(editMode == levelEdit)
@@ -674,6 +709,44 @@ void printouts()
 	ss << "|v| Frozen: " << AnimationController::frozen;
 	drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-100, ss.str().c_str());
 
+	ss.str(std::string()); // clear
+	ss << "Bones animated: " << bonesEvaluated << " / " << bonesTotal;
+	drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-120, ss.str().c_str());
+
+	const FrameStats& frameStats = scheduler.GetStats();
+
+	ss.str(std::string()); // clear
+	ss << std::fixed << std::setprecision(2) << "Frame: " << frameStats.averageFrameTime << " ms, simulation: " << frameStats.averageSimulationTime 
+		<< " ms (" << frameStats.steps << " steps, " << frameStats.droppedSteps << " dropped)";
+	drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-140, ss.str().c_str());
+
+	ss.str(std::string()); // clear
+	ss << "Objects visible: " << objectsVisible << ", culled: " << objectsCulled;
+	drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-160, ss.str().c_str());
+
+	//PRINT PROFILE
+	const std::vector<ProfileSummary>& profile = Profiler::GetSummaries();
+
+	ss.str(std::string()); // clear
+	ss << "|F9| Save profile.json";
+	drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-180, ss.str().c_str());
+
+	for(int i = 0; i < profile.size(); i++)
+	{
+		ss.str(std::string()); // clear
+		ss << std::fixed << std::setprecision(3) << profile[i].name << ": " << profile[i].averageTime << " ms (" << profile[i].calls << ")";
+		drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-200-i*20, ss.str().c_str());
+	}
+
+	for(int i = 0; i < Profiler::GetNumCounters(); i++)
+	{
+		const ProfileCounter* counter = Profiler::GetCounter(i);
+
+		ss.str(std::string()); // clear
+		ss << counter->name << ": " << counter->lastFrame;
+		drawText(WINDOW_WIDTH-(strlen(ss.str().c_str())*LETTER_WIDTH),WINDOW_HEIGHT-200-(profile.size()+i)*20, ss.str().c_str());
+	}
+
 	//PRINT CAMERA
 	ss.str(std::string()); // clear
 	ss << "camera.forward: (" << std::fixed << std::setprecision(PRECISION) << camera.viewProperties.forward.x << ", " << camera.viewProperties.forward.y << ", " << camera.viewProperties.forward.z << ")";